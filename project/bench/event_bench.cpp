@@ -0,0 +1,103 @@
+#include "../include/event_queue.h"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Microbenchmark of the calendar queue against a binary heap of the same
+// compact events, using the classic "hold" model: with N events pending,
+// repeatedly pop the earliest and push a replacement a random delay later.
+// Usage: event_bench [max_pending]   (default 10000000)
+
+struct HeapQueue {
+  static constexpr const char* name = "priority_queue";
+  struct Later {
+    bool operator()(const pair<Event, long>& a, const pair<Event, long>& b) const {
+      return a.first.time != b.first.time ? a.first.time > b.first.time : a.second > b.second;
+    }
+  };
+  // The sequence number keeps equal times in push order, as EventQueue does
+  priority_queue<pair<Event, long>, vector<pair<Event, long>>, Later> heap;
+  long seq = 0;
+
+  void push(const Event& event) { heap.push({event, seq++}); }
+  const Event& top() { return heap.top().first; }
+  void pop() { heap.pop(); }
+};
+
+struct CalendarQueue {
+  static constexpr const char* name = "EventQueue";
+  EventQueue queue;
+
+  void push(const Event& event) { queue.push(event); }
+  const Event& top() { return queue.top(); }
+  void pop() { queue.pop(); }
+};
+
+const long HOLDS = 10000000;  // Pop/push pairs per size
+
+static void report(const string& name, long n, const string& op, long ops,
+                   chrono::steady_clock::time_point start) {
+  double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+  cout << name << "\t" << n << "\t" << op << "\t" << fixed << setprecision(1) << ns / ops << endl;
+}
+
+template <typename Queue>
+static void bench(long n) {
+  // Delays drawn before timing: mostly short, like slice ends, with a tail
+  // of long ones, like I/O waits
+  mt19937 rng(n);
+  exponential_distribution<double> delay(1.0 / 50);
+  vector<int> delays(HOLDS);
+  for (long i = 0; i < HOLDS; i++) {
+    delays[i] = 1 + (int)delay(rng);
+  }
+
+  Queue queue;
+  auto start = chrono::steady_clock::now();
+  for (long i = 0; i < n; i++) {
+    queue.push({delays[i % HOLDS], (int)i, EVENT_SLICE_END});
+  }
+  report(Queue::name, n, "push", n, start);
+
+  long checksum = 0;
+  start = chrono::steady_clock::now();
+  for (long i = 0; i < HOLDS; i++) {
+    Event event = queue.top();
+    queue.pop();
+    checksum += event.id;
+    event.time += delays[i];
+    queue.push(event);
+  }
+  report(Queue::name, n, "hold", HOLDS, start);
+
+  start = chrono::steady_clock::now();
+  for (long i = 0; i < n; i++) {
+    checksum += queue.top().id;
+    queue.pop();
+  }
+  report(Queue::name, n, "drain", n, start);
+
+  // Stored so the compiler cannot drop the loops
+  volatile long sink = checksum;
+  (void)sink;
+}
+
+int main(int argc, char* argv[]) {
+  long max_pending = argc > 1 ? atol(argv[1]) : 10000000;
+
+  cout << "Structure\tPending\tOp\tns/op" << endl;
+  cout << "--------------------------------------" << endl;
+  for (long n = 1000; n <= max_pending; n *= 10) {
+    bench<HeapQueue>(n);
+    bench<CalendarQueue>(n);
+  }
+  return 0;
+}
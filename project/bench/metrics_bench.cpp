@@ -0,0 +1,79 @@
+#include "../include/metrics.h"
+#include "../include/workload.h"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+
+using namespace std;
+
+// Microbenchmark of the single-pass summarize() over completion columns
+// against the list-based helpers it replaced (one pass each for average
+// turnaround, average response and fairness).
+// Usage: metrics_bench [max_records]   (default 1000000)
+
+const int REPEATS = 5;  // Each figure is the best of this many runs
+
+// Runs body REPEATS times and prints the fastest, in ms per run
+static void measure(const string& name, long n, const function<void()>& body) {
+  double best = 0;
+  for (int i = 0; i < REPEATS; i++) {
+    auto start = chrono::steady_clock::now();
+    body();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    if (i == 0 || ms < best) best = ms;
+  }
+  cout << name << "\t" << n << "\t" << fixed << setprecision(3) << best << endl;
+}
+
+static void bench(long n) {
+  // Completions drawn before timing, in arrival order as a scheduler would
+  // roughly emit them
+  mt19937 rng(n);
+  list<Process> processes;
+  CompletionColumns columns;
+  columns.reserve(n);
+  int arrival = 0;
+  for (long i = 0; i < n; i++) {
+    Process p = {};
+    p.pid = i + 1;
+    arrival += rng() % 4;
+    p.arrival = arrival;
+    p.duration = 1 + rng() % 50;
+    p.service = p.duration;
+    p.first_run = arrival + rng() % 100;
+    p.completion = p.first_run + p.duration + rng() % 200;
+    p.nice_value = (int)(rng() % 40) - 20;
+    initializeWeight(p);
+    processes.push_back(p);
+    columns.complete(p);
+  }
+
+  volatile double sink = 0;
+  measure("list passes", n, [&]() {
+    sink = avg_turnaround(processes) + avg_response(processes) + fairness_index(processes);
+  });
+  measure("to_columns", n, [&]() {
+    sink = to_columns(processes).size();
+  });
+  measure("summarize", n, [&]() {
+    MetricsSummary summary = summarize(columns.span());
+    sink = summary.avg_turnaround + summary.avg_response + summary.fairness;
+  });
+  (void)sink;
+}
+
+int main(int argc, char* argv[]) {
+  long max_records = argc > 1 ? atol(argv[1]) : 1000000;
+
+  cout << "Kernel\tRecords\tms" << endl;
+  cout << "------------------------------" << endl;
+  for (long n = 1000; n <= max_records; n *= 10) {
+    bench(n);
+  }
+  return 0;
+}
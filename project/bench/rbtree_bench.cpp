@@ -0,0 +1,281 @@
+#include "../include/rb_tree.h"
+#include "../include/pairing_heap.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Microbenchmarks of the CFS runqueue against alternative structures, and
+// against MLFQ's bitmap-indexed levels for the cost of picking the next task.
+// Usage: rbtree_bench [max_entries]   (default 1000000, up to 10000000)
+
+// Every heap allocation in the process goes through here, so each phase can
+// report how many it caused
+static long allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* p = malloc(size ? size : 1)) return p;
+  throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Last-level cache misses of this thread, when the kernel lets us count them
+class CacheMissCounter {
+ public:
+  CacheMissCounter() : fd(-1) {
+#ifdef __linux__
+    perf_event_attr attr = {};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+  ~CacheMissCounter() {
+#ifdef __linux__
+    if (fd >= 0) close(fd);
+#endif
+  }
+
+  bool available() const { return fd >= 0; }
+
+  void start() {
+#ifdef __linux__
+    if (fd < 0) return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  long long stop() {
+    long long count = 0;
+#ifdef __linux__
+    if (fd < 0) return 0;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+    return count;
+  }
+
+ private:
+  int fd;
+};
+
+static CacheMissCounter cache_misses;
+
+// Stops the compiler from hoisting a loop-invariant query out of a loop
+static inline void clobber_memory() {
+#if defined(__GNUC__)
+  asm volatile("" : : : "memory");
+#endif
+}
+
+// Runs body once and prints a row of per-op figures
+static void measure(const string& name, long n, const string& op, long ops, const function<void()>& body) {
+  long allocs_before = allocations;
+  cache_misses.start();
+  auto start = chrono::steady_clock::now();
+  body();
+  auto end = chrono::steady_clock::now();
+  long long misses = cache_misses.stop();
+  long allocs = allocations - allocs_before;
+
+  double ns = chrono::duration<double, nano>(end - start).count();
+  cout << name << "\t" << n << "\t" << op << "\t"
+       << fixed << setprecision(1) << ns / ops << "\t"
+       << setprecision(3) << (double)allocs / ops << "\t";
+  if (cache_misses.available()) {
+    cout << setprecision(3) << (double)misses / ops;
+  } else {
+    cout << "n/a";
+  }
+  cout << endl;
+}
+
+// Adapters giving every structure the runqueue operations CFS performs:
+// insert a task, peek at the minimum, remove a task by handle, and run the
+// pick-next/requeue cycle (take the minimum and reinsert it with a larger key)
+
+struct RBTreeQueue {
+  static constexpr const char* name = "RBTree";
+  static constexpr bool has_remove = true;
+  RBTree tree;
+  vector<RBNode*> handles;
+
+  RBTreeQueue(long n) : handles(n) {}
+  void insert(int id, int key) { handles[id] = tree.insert(id, key); }
+  int minKey() { return tree.minNode()->vruntime; }
+  void remove(int id) { tree.remove(handles[id]); }
+  void cycle(int delta) {
+    RBNode* node = tree.minNode();
+    tree.requeue(node, node->vruntime + delta);
+  }
+};
+
+struct MultimapQueue {
+  static constexpr const char* name = "multimap";
+  static constexpr bool has_remove = true;
+  multimap<int, int> tree;
+  vector<multimap<int, int>::iterator> handles;
+
+  MultimapQueue(long n) : handles(n) {}
+  void insert(int id, int key) { handles[id] = tree.emplace(key, id); }
+  int minKey() { return tree.begin()->first; }
+  void remove(int id) { tree.erase(handles[id]); }
+  void cycle(int delta) {
+    // Re-link the same node rather than freeing and allocating a new one
+    auto node = tree.extract(tree.begin());
+    node.key() += delta;
+    int id = node.mapped();
+    handles[id] = tree.insert(std::move(node));
+  }
+};
+
+struct BinaryHeapQueue {
+  static constexpr const char* name = "priority_queue";
+  static constexpr bool has_remove = false;  // No removal of arbitrary entries
+  priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> heap;
+
+  BinaryHeapQueue(long) {}
+  void insert(int id, int key) { heap.push({key, id}); }
+  int minKey() { return heap.top().first; }
+  void remove(int) {}
+  void cycle(int delta) {
+    pair<int, int> top = heap.top();
+    heap.pop();
+    heap.push({top.first + delta, top.second});
+  }
+};
+
+struct PairingHeapQueue {
+  static constexpr const char* name = "PairingHeap";
+  static constexpr bool has_remove = true;
+  PairingHeap heap;
+  vector<PairingNode*> handles;
+
+  PairingHeapQueue(long n) : handles(n) {}
+  void insert(int id, int key) { handles[id] = heap.insert(id, key); }
+  int minKey() { return heap.minNode()->vruntime; }
+  void remove(int id) { heap.remove(handles[id]); }
+  void cycle(int delta) {
+    PairingNode* node = heap.minNode();
+    heap.requeue(node, node->vruntime + delta);
+  }
+};
+
+// MLFQ's pick: a FIFO per priority level and a bitmap of the non-empty
+// ones, as in mlfq(). There is no vruntime; a key only picks the level a task
+// is queued on, so findMin peeks at the first task of the highest level.
+struct LevelBitmapQueue {
+  static constexpr const char* name = "LevelBitmap";
+  static constexpr bool has_remove = false;  // mlfq() never removes a queued task
+  static const int LEVELS = 8;
+  deque<int> levels[LEVELS];
+  uint64_t bitmap = 0;
+
+  LevelBitmapQueue(long) {}
+  void insert(int id, int key) { push(key % LEVELS, id); }
+  int minKey() { return levels[__builtin_ctzll(bitmap)].front(); }
+  void remove(int) {}
+  void cycle(int delta) {
+    int level = __builtin_ctzll(bitmap);
+    int id = levels[level].front();
+    levels[level].pop_front();
+    if (levels[level].empty()) bitmap &= ~(1ULL << level);
+    push(delta % LEVELS, id);
+  }
+
+ private:
+  void push(int level, int id) {
+    levels[level].push_back(id);
+    bitmap |= 1ULL << level;
+  }
+};
+
+const long OPS = 1000000;  // findMin and pick/requeue operations per size
+
+template <typename Queue>
+static void bench(long n) {
+  // Inputs are drawn before timing. Keys spread over [0, n) and a requeued
+  // task moves anywhere in the queue, as it would under mixed weights.
+  mt19937 rng(n);
+  vector<int> keys(n), deltas(OPS), order(n);
+  for (long i = 0; i < n; i++) {
+    keys[i] = rng() % n;
+    order[i] = i;
+  }
+  for (long i = 0; i < OPS; i++) {
+    deltas[i] = 1 + rng() % n;
+  }
+  shuffle(order.begin(), order.end(), rng);
+
+  Queue queue(n);
+  measure(Queue::name, n, "insert", n, [&]() {
+    for (long i = 0; i < n; i++) queue.insert(i, keys[i]);
+  });
+
+  volatile long sink = 0;
+  measure(Queue::name, n, "findMin", OPS, [&]() {
+    long sum = 0;
+    for (long i = 0; i < OPS; i++) {
+      sum += queue.minKey();
+      clobber_memory();
+    }
+    sink = sum;
+  });
+  (void)sink;
+
+  measure(Queue::name, n, "pick/requeue", OPS, [&]() {
+    for (long i = 0; i < OPS; i++) queue.cycle(deltas[i]);
+  });
+
+  if (Queue::has_remove) {
+    measure(Queue::name, n, "remove", n, [&]() {
+      for (long i = 0; i < n; i++) queue.remove(order[i]);
+    });
+  } else {
+    cout << Queue::name << "\t" << n << "\tremove\tn/a\tn/a\tn/a" << endl;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  long max_entries = argc > 1 ? atol(argv[1]) : 1000000;
+
+  if (!cache_misses.available()) {
+    cout << "# Hardware cache-miss counter unavailable; reporting n/a" << endl;
+  }
+  cout << "Structure\tN\tOp\tns/op\tallocs/op\tmisses/op" << endl;
+  cout << "------------------------------------------------------------" << endl;
+  for (long n = 1000; n <= max_entries; n *= 10) {
+    bench<RBTreeQueue>(n);
+    bench<MultimapQueue>(n);
+    bench<BinaryHeapQueue>(n);
+    bench<PairingHeapQueue>(n);
+    bench<LevelBitmapQueue>(n);
+  }
+  return 0;
+}
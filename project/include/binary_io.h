@@ -0,0 +1,20 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <istream>
+#include <ostream>
+
+using namespace std;
+
+// Raw native-endian reads and writes of trivially copyable values
+template <typename T>
+inline void write_value(ostream& out, const T& value) {
+  out.write((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+inline bool read_value(istream& in, T& value) {
+  return (bool)in.read((char*)&value, sizeof(T));
+}
+
+#endif // BINARY_IO_H
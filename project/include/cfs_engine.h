@@ -0,0 +1,92 @@
+#ifndef CFS_ENGINE_H
+#define CFS_ENGINE_H
+
+#include "process.h"
+#include "schedulers.h"
+#include "metrics.h"
+#include "task_table.h"
+#include "event_queue.h"
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// A task as captured in a snapshot. proc.duration is the time still needed
+// and proc.vruntime its current key.
+struct TaskState {
+  Process proc;
+  int burst_left = 0;  // See SchedEntity
+  int woke_at = -1;
+  int wake_time = 0;   // Sleeping tasks only: end of the I/O wait
+};
+
+// Complete state of a paused CFS run. Restoring it into a fresh engine and
+// continuing with the rest of the same arrivals gives exactly the schedule
+// the uninterrupted run would have produced.
+struct CFSSnapshot {
+  bool started = false;
+  int time = 0;
+  int min_vruntime = 0;
+  long arrivals_consumed = 0;  // Processes already taken from the workload
+  long workload_size = 0;      // The workload arrivals_consumed indexes into...
+  uint64_t workload_checksum = 0;  // ...and its workload_checksum()
+  vector<TaskState> runnable;  // Runqueue order
+  vector<TaskState> sleeping;  // Blocked on I/O, in wakeup order
+  int last_pid = -1;           // Last process dispatched, for switch accounting
+  SchedStats switch_stats;
+  OnlineMetrics metrics;       // Completions so far, filled by the sink's owner
+};
+
+// Writes and reads a snapshot in a native-endian binary file
+bool save_snapshot(const CFSSnapshot& snapshot, string filename);
+bool load_snapshot(string filename, CFSSnapshot& snapshot);
+
+// The CFS loop of cfs<RunQueue>() as an object that can stop at a given
+// time, be snapshotted, and be restored into any number of copies
+template <typename RunQueue>
+class CFSEngine {
+ public:
+  CFSEngine(const CFSParams& params = CFSParams(), const SwitchCost& cost = SwitchCost());
+
+  // Schedules until every process has completed (returns true) or the clock
+  // has reached `until` (returns false). Only a preempting arrival or wakeup
+  // cuts a slice short, `until` never does, so the clock may stop a little
+  // past `until`.
+  bool run(ArrivalFeed& workload, CompletionSink& sink, int until = INT_MAX);
+  void finish(SchedStats* stats) { switches.finish(time, stats); }
+
+  CFSSnapshot snapshot();
+  void restore(const CFSSnapshot& snapshot);
+  int now() const { return time; }
+
+  CFSEngine(const CFSEngine&) = delete;
+  CFSEngine& operator=(const CFSEngine&) = delete;
+
+ private:
+  int admit(const Process& p);
+  void enqueueDue(ArrivalFeed& workload);
+  int placeArrival() const;
+  int placeWakeup(int id);
+  int preemptionPoint(ArrivalFeed& workload, const SchedEntity& curr, int start, int end);
+  void block(int id, int vruntime);
+  void wakeup(int id, int wake_time);
+
+  CFSParams params;
+  RunQueue runqueue;  // Task ids keyed on vruntime
+  TaskTable tasks;
+  EventQueue sleepers;  // I/O completions; equal times wake in the order tasks blocked
+  // Taken off the feed and the sleep queue while checking for preemption,
+  // enqueued before anything else once the slice is over
+  vector<Process> early_arrivals;
+  vector<Event> early_wakeups;
+  SwitchTracker switches;
+  bool started;
+  int time;
+  int min_vruntime;
+  int num_runnable;  // runqueue size
+  long arrivals_consumed;
+};
+
+#endif // CFS_ENGINE_H
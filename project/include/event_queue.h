@@ -0,0 +1,65 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <vector>
+
+using namespace std;
+
+// Timer events of the simulators. Arrivals come from an ArrivalFeed, which is
+// already in time order; everything a scheduler sets for itself goes here.
+enum EventKind {
+  EVENT_SLICE_END,    // id is the CPU whose slice ends
+  EVENT_IO_COMPLETE,  // id is the task whose I/O finishes
+  EVENT_BALANCE       // Periodic load balancing tick
+};
+
+struct Event {
+  int time;
+  int id;
+  EventKind kind;
+};
+
+// Calendar queue (R. Brown, 1988): a ring of buckets, each covering `width`
+// time units of one "year" of buckets * width. An event goes to the bucket
+// of its time modulo the year, and dequeueing walks the ring from the
+// current bucket, so both are O(1) on average as long as width matches the
+// spacing of events. The ring doubles or halves with the queue, re-estimating
+// width from the events nearest the front.
+//
+// Events with equal times come out in the order they were pushed. Simulated
+// time never goes backwards, so pushing before the last popped time is
+// allowed but slow (it rewinds the scan).
+class EventQueue {
+ public:
+  EventQueue();
+
+  void push(const Event& event);
+  const Event& top();  // Earliest event; the queue must not be empty
+  void pop();
+  bool empty() const { return count == 0; }
+  long size() const { return count; }
+
+ private:
+  static const int MIN_BUCKETS = 16;
+
+  // Events sorted by time, oldest push first among equal times. Popped
+  // events are skipped over by head until the bucket drains.
+  struct Bucket {
+    vector<Event> events;
+    size_t head = 0;
+  };
+
+  int bucketOf(int time) const { return (time / width) & (int)(buckets.size() - 1); }
+  void insert(const Event& event);
+  void seek();  // Moves cur to the bucket holding the earliest event
+  void rewind(int time);  // Restarts the scan at the window holding time
+  void resize(int num_buckets);
+
+  vector<Bucket> buckets;
+  int width;
+  int cur;               // Bucket being scanned
+  long long bucket_end;  // First time past the current bucket's window
+  long count;
+};
+
+#endif // EVENT_QUEUE_H
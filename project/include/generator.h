@@ -0,0 +1,74 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "process.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+enum class ArrivalPattern { POISSON, BURSTY };
+enum class DurationDistribution { EXPONENTIAL, PARETO, LOGNORMAL };
+
+// Fraction of generated processes that get a given nice value
+struct NiceShare {
+  int nice_value;
+  double share;
+};
+
+struct GeneratorConfig {
+  long count = 1000;
+  uint64_t seed = 1;
+
+  // Arrivals are a Poisson process. Bursty arrivals switch between a calm and
+  // a burst phase (a two-state Markov-modulated Poisson process).
+  ArrivalPattern arrivals = ArrivalPattern::POISSON;
+  double arrival_rate = 1.0;        // Mean arrivals per time unit
+  double burst_rate_factor = 10.0;  // Rate multiplier while in a burst
+  double burst_start_prob = 0.01;   // Per-arrival chance a burst begins
+  double burst_end_prob = 0.1;      // Per-arrival chance a burst ends
+
+  DurationDistribution durations = DurationDistribution::PARETO;
+  double mean_duration = 20.0;
+  double duration_shape = 1.5;      // Pareto alpha (> 1) or lognormal sigma
+  int max_duration = 1000000;
+
+  vector<NiceShare> nice_mix = {{0, 1.0}};
+  double io_fraction = 0.0;         // Share of I/O-bound processes
+  float io_ratio_min = 0.5;
+  float io_ratio_max = 0.9;
+};
+
+// Processes are generated in fixed-size chunks, each with its own generator
+// seeded from (seed, chunk index), so the output depends only on the config
+// and not on how many threads produced it.
+const long GENERATOR_CHUNK = 1 << 16;
+
+// Generates config.count processes in scheduler arrival order (arrival, then
+// duration), with pids 1..count in row order, spread over all cores. Arrival
+// times are ints, so a config that runs past INT_MAX is cut short there.
+vector<Process> generate_workload(const GeneratorConfig& config, int max_threads = 0);
+
+// Produces the same processes as generate_workload() one chunk at a time, so
+// arbitrarily long traces can be fed to a scheduler in bounded memory
+class GeneratorFeed : public ArrivalFeed {
+ public:
+  GeneratorFeed(const GeneratorConfig& config);
+
+  bool empty() const override { return next_row >= chunk.size(); }
+  const Process& top() const override { return chunk[next_row]; }
+  void pop() override;
+
+ private:
+  void fill();
+
+  GeneratorConfig config;
+  long next_chunk;
+  double time_offset;  // Exact time the last generated chunk ended
+  long next_pid;
+  vector<Process> chunk;
+  vector<Process> held;  // Tail of the last chunk that may tie with the next
+  size_t next_row;
+};
+
+#endif // GENERATOR_H
@@ -0,0 +1,50 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+using namespace std;
+
+// Log-bucketed (HDR-style) histogram of non-negative integer latencies.
+// Values below 2 * SUB_BUCKETS are counted exactly; above that every power of
+// two is split into SUB_BUCKETS linear buckets, so any reported percentile is
+// within 1 / SUB_BUCKETS (~3%) of the true value. Recording is a couple of
+// bit operations and an increment.
+class LatencyHistogram {
+ public:
+  static const int SUB_BUCKET_BITS = 5;
+  static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+  LatencyHistogram();
+
+  void record(int64_t value);
+  void merge(const LatencyHistogram& other);
+
+  // Smallest recorded bucket bound with at least percentile% of values at or
+  // below it, e.g. percentile(99.9)
+  int64_t percentile(double percentile) const;
+
+  uint64_t count() const { return total; }
+  int64_t min() const { return total ? min_value : 0; }
+  int64_t max() const { return total ? max_value : 0; }
+  double mean() const { return total ? (double)sum / total : 0.0; }
+
+  // Raw state, for checkpoints
+  void save(ostream& out) const;
+  bool load(istream& in);
+
+ private:
+  static int bucketIndex(int64_t value);
+  static int64_t bucketUpperBound(int index);
+
+  vector<uint64_t> counts;
+  uint64_t total;
+  int64_t min_value;
+  int64_t max_value;
+  double sum;
+};
+
+#endif // HISTOGRAM_H
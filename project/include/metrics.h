@@ -2,11 +2,103 @@
 #define METRICS_H
 
 #include <process.h>
+#include "histogram.h"
 
-float avg_turnaround(list<Process> processes);
-float avg_response(list<Process> processes);
-void show_metrics(list<Process> processes);
-float fairness_index(list<Process> processes);
-float throughput(list<Process> processes, int total_time);
+float avg_turnaround(const list<Process>& processes);
+float avg_response(const list<Process>& processes);
+void show_metrics(const list<Process>& processes);
+float fairness_index(const list<Process>& processes);
+float throughput(const list<Process>& processes, int total_time);
+
+// Read-only view of completion records stored column by column. Nothing is
+// copied; the columns belong to whoever filled them (e.g. CompletionColumns).
+struct CompletionSpan {
+  const int* arrival;
+  const int* first_run;
+  const int* completion;
+  const int* service;
+  const int* weight;
+  size_t size;
+
+  CompletionSpan subspan(size_t offset, size_t count) const {
+    return {arrival + offset, first_run + offset, completion + offset,
+            service + offset, weight + offset, count};
+  }
+};
+
+// Sink that stores completions as struct-of-arrays columns, ready for
+// summarize() without another copy
+class CompletionColumns : public CompletionSink {
+ public:
+  void complete(const Process& p) override;
+  void reserve(size_t n);
+  size_t size() const { return arrival.size(); }
+  CompletionSpan span() const;
+
+ private:
+  vector<int> arrival, first_run, completion, service, weight;
+};
+
+CompletionColumns to_columns(const list<Process>& processes);
+
+struct MetricsSummary {
+  long count = 0;
+  double avg_turnaround = 0;
+  double avg_response = 0;
+  double fairness = 1.0;
+  double throughput = 0;
+  int total_time = 0;  // Latest completion
+};
+
+// Every scalar metric in one pass over the columns
+MetricsSummary summarize(const CompletionSpan& span);
+
+// Fills all three latency histograms in one pass
+void record_latencies(const CompletionSpan& span, LatencyHistogram& response,
+                      LatencyHistogram& turnaround, LatencyHistogram& wait);
+
+// Latency distributions for tail percentiles
+LatencyHistogram turnaround_histogram(const list<Process>& processes);
+LatencyHistogram response_histogram(const list<Process>& processes);
+LatencyHistogram wait_histogram(const list<Process>& processes);  // Turnaround minus service time
+void show_percentiles(const LatencyHistogram& response, const LatencyHistogram& turnaround,
+                      const LatencyHistogram& wait);
+
+// Accumulates the same metrics on the completion path in O(1) memory:
+// running means with Welford variance for turnaround and response, and the
+// sums behind Jain's fairness index. Merge combines partial results, e.g.
+// from several threads.
+class OnlineMetrics : public CompletionSink {
+ public:
+  void complete(const Process& p) override;
+  void merge(const OnlineMetrics& other);
+
+  long count() const { return n; }
+  double avgTurnaround() const { return mean_turnaround; }
+  double avgResponse() const { return mean_response; }
+  double turnaroundVariance() const { return n > 1 ? m2_turnaround / (n - 1) : 0.0; }
+  double responseVariance() const { return n > 1 ? m2_response / (n - 1) : 0.0; }
+  double fairnessIndex() const;
+  double throughput() const;
+  int totalTime() const { return max_completion; }
+  const LatencyHistogram& turnaroundHistogram() const { return turnaround_hist; }
+  const LatencyHistogram& responseHistogram() const { return response_hist; }
+  const LatencyHistogram& waitHistogram() const { return wait_hist; }
+
+  // Raw state, for checkpoints
+  void save(ostream& out) const;
+  bool load(istream& in);
+
+ private:
+  long n = 0;
+  double mean_turnaround = 0, m2_turnaround = 0;
+  double mean_response = 0, m2_response = 0;
+  long rated = 0;  // Completions in the fairness sums (turnaround > 0)
+  double sum_ratio = 0, sum_ratio_sq = 0;
+  int max_completion = 0;
+  LatencyHistogram turnaround_hist, response_hist, wait_hist;
+};
+
+void show_metrics(const OnlineMetrics& metrics);
 
 #endif
\ No newline at end of file
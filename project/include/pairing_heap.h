@@ -0,0 +1,205 @@
+#ifndef PAIRING_HEAP_H
+#define PAIRING_HEAP_H
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+struct PairingNode {
+  int vruntime;
+  int id;
+  unsigned long long seq;  // Insert/requeue order, breaks ties like RBTree
+  PairingNode* child;    // Leftmost child
+  PairingNode* sibling;  // Next sibling to the right
+  PairingNode* prev;     // Left sibling, or parent for a leftmost child
+};
+
+// Min pairing heap keyed on vruntime, with the same handle-based interface as
+// RBTree: insert returns a node that stays valid until it is removed. Insert
+// and merge are O(1), popMin is amortized O(log n). Nodes are recycled
+// through a free list, as in RBTree. Equal keys come out in the order they
+// were inserted or requeued, matching RBTree.
+class PairingHeap {
+ public:
+  PairingHeap() : root(nullptr), free_list(nullptr), count(0), next_seq(0) {}
+  ~PairingHeap() {
+    destroy(root);
+    while (free_list != nullptr) {
+      PairingNode* next = free_list->sibling;
+      delete free_list;
+      free_list = next;
+    }
+  }
+
+  PairingHeap(const PairingHeap&) = delete;
+  PairingHeap& operator=(const PairingHeap&) = delete;
+
+  PairingNode* insert(int id, int vruntime) {
+    PairingNode* node = allocNode(id, vruntime);
+    root = meld(root, node);
+    count++;
+    return node;
+  }
+
+  int findMin() const { return root ? root->id : -1; }
+  PairingNode* minNode() const { return root; }
+
+  int popMin() {
+    if (root == nullptr) return -1;
+    int id = root->id;
+    remove(root);
+    return id;
+  }
+
+  void remove(PairingNode* node) {
+    cut(node);
+    count--;
+    freeNode(node);
+  }
+
+  // Re-key a node. A smaller key only cuts the node's subtree and melds it
+  // back at the root; any other key has to go through remove and insert,
+  // since the node now sorts after its equal-keyed children.
+  void requeue(PairingNode* node, int new_vruntime) {
+    if (new_vruntime < node->vruntime) {
+      node->vruntime = new_vruntime;
+      node->seq = next_seq++;
+      if (node != root) {
+        detach(node);
+        root = meld(root, node);
+      }
+      return;
+    }
+
+    cut(node);
+    node->vruntime = new_vruntime;
+    node->seq = next_seq++;
+    node->child = nullptr;
+    root = meld(root, node);
+  }
+
+  bool isEmpty() const { return root == nullptr; }
+  int size() const { return count; }
+
+  // Every node, in the order popMin would return them
+  vector<PairingNode*> nodesInOrder() const {
+    vector<PairingNode*> nodes;
+    vector<PairingNode*> stack;
+    if (root) stack.push_back(root);
+    while (!stack.empty()) {
+      PairingNode* n = stack.back();
+      stack.pop_back();
+      nodes.push_back(n);
+      if (n->child) stack.push_back(n->child);
+      if (n->sibling) stack.push_back(n->sibling);
+    }
+    sort(nodes.begin(), nodes.end(), before);
+    return nodes;
+  }
+
+ private:
+  PairingNode* allocNode(int id, int vruntime) {
+    PairingNode* node = free_list;
+    if (node == nullptr) {
+      node = new PairingNode;
+    } else {
+      free_list = node->sibling;
+    }
+    node->vruntime = vruntime;
+    node->id = id;
+    node->seq = next_seq++;
+    node->child = node->sibling = node->prev = nullptr;
+    return node;
+  }
+
+  void freeNode(PairingNode* node) {
+    node->sibling = free_list;
+    free_list = node;
+  }
+
+  static bool before(const PairingNode* a, const PairingNode* b) {
+    return a->vruntime != b->vruntime ? a->vruntime < b->vruntime : a->seq < b->seq;
+  }
+
+  // Links two heap roots, the larger becoming the leftmost child
+  static PairingNode* meld(PairingNode* a, PairingNode* b) {
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
+    if (before(b, a)) swap(a, b);
+    b->prev = a;
+    b->sibling = a->child;
+    if (a->child) a->child->prev = b;
+    a->child = b;
+    a->sibling = nullptr;
+    return a;
+  }
+
+  // Unhooks a non-root node (and its subtree) from its parent or siblings
+  static void detach(PairingNode* node) {
+    if (node->prev->child == node) {
+      node->prev->child = node->sibling;
+    } else {
+      node->prev->sibling = node->sibling;
+    }
+    if (node->sibling) node->sibling->prev = node->prev;
+    node->sibling = nullptr;
+    node->prev = nullptr;
+  }
+
+  // Takes a node out of the heap, melding its children back in
+  void cut(PairingNode* node) {
+    if (node == root) {
+      root = combine(root->child);
+      if (root) root->prev = nullptr;
+      return;
+    }
+    detach(node);
+    PairingNode* rest = combine(node->child);
+    if (rest) {
+      rest->prev = nullptr;
+      root = meld(root, rest);
+    }
+  }
+
+  // Standard two-pass pairing of a sibling list: meld pairs left to right,
+  // then fold the results right to left
+  PairingNode* combine(PairingNode* first) {
+    if (first == nullptr) return nullptr;
+    pairs.clear();
+    while (first != nullptr) {
+      PairingNode* a = first;
+      PairingNode* b = a->sibling;
+      first = b ? b->sibling : nullptr;
+      a->sibling = a->prev = nullptr;
+      if (b) b->sibling = b->prev = nullptr;
+      pairs.push_back(meld(a, b));
+    }
+    PairingNode* result = pairs.back();
+    for (int i = (int)pairs.size() - 2; i >= 0; i--) {
+      result = meld(pairs[i], result);
+    }
+    return result;
+  }
+
+  void destroy(PairingNode* node) {
+    // Iterative, since sibling lists can be as long as the heap
+    vector<PairingNode*> stack;
+    if (node) stack.push_back(node);
+    while (!stack.empty()) {
+      PairingNode* n = stack.back();
+      stack.pop_back();
+      if (n->child) stack.push_back(n->child);
+      if (n->sibling) stack.push_back(n->sibling);
+      delete n;
+    }
+  }
+
+  PairingNode* root;
+  PairingNode* free_list;
+  int count;
+  unsigned long long next_seq;
+  vector<PairingNode*> pairs;  // Scratch space for combine()
+};
+
+#endif // PAIRING_HEAP_H
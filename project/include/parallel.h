@@ -0,0 +1,35 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Runs body(0) .. body(n - 1) on a small pool of worker threads. Workers pull
+// the next index from a shared counter, so uneven jobs still balance out.
+inline void parallel_for(int n, const function<void(int)>& body, int max_threads = 0) {
+  int num_threads = max_threads > 0 ? max_threads : (int)thread::hardware_concurrency();
+  num_threads = max(1, min(num_threads, n));
+
+  atomic<int> next(0);
+  auto worker = [&]() {
+    for (int i = next++; i < n; i = next++) {
+      body(i);
+    }
+  };
+
+  vector<thread> pool;
+  for (int t = 1; t < num_threads; t++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (thread& t : pool) {
+    t.join();
+  }
+}
+
+#endif // PARALLEL_H
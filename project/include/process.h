@@ -14,6 +14,7 @@ struct Process {
   int arrival;
   int first_run;
   int duration;
+  int service;         // Total CPU time requested, duration counts down to 0
   int completion;
   // CFS parameters
   int nice_value;      
@@ -26,18 +27,20 @@ struct Process {
 
 class DurationComparator {
  public:
-  bool operator()(const Process lhs, const Process rhs) const {
+  bool operator()(const Process& lhs, const Process& rhs) const {
     if (lhs.duration != rhs.duration)
       return lhs.duration > rhs.duration;
-    else
+    else if (lhs.arrival != rhs.arrival)
       return lhs.arrival > rhs.arrival;
+    else
+      return lhs.pid > rhs.pid;
   }
 };
 
 // Comparator for arrival time priority queue
 class ArrivalComparator {
  public:
-  bool operator()(const Process lhs, const Process rhs) const {
+  bool operator()(const Process& lhs, const Process& rhs) const {
     if (lhs.arrival != rhs.arrival)
       return lhs.arrival > rhs.arrival;
     else
@@ -50,6 +53,79 @@ typedef priority_queue<Process, vector<Process>, ArrivalComparator>
 typedef priority_queue<Process, vector<Process>, DurationComparator>
     pqueue_duration;
 
+// Source of processes in arrival order. Schedulers pull from it as simulated
+// time advances, the same way they would pop a pqueue_arrival.
+class ArrivalFeed {
+ public:
+  virtual ~ArrivalFeed() {}
+  virtual bool empty() const = 0;
+  virtual const Process& top() const = 0;
+  virtual void pop() = 0;
+};
+
+// Cursor over a shared, read-only workload sorted by arrival. Every scheduler
+// run gets its own cursor, so concurrent runs never copy the workload.
+class VectorFeed : public ArrivalFeed {
+ public:
+  VectorFeed(const vector<Process>& arrivals, size_t start = 0) : arrivals(arrivals), next(start) {}
+  bool empty() const override { return next >= arrivals.size(); }
+  const Process& top() const override { return arrivals[next]; }
+  void pop() override { next++; }
+
+ private:
+  const vector<Process>& arrivals;
+  size_t next;
+};
+
+// Interleaves two arrival-ordered feeds; on equal arrival times the first
+// one goes first
+class MergedFeed : public ArrivalFeed {
+ public:
+  MergedFeed(ArrivalFeed& first, ArrivalFeed& second) : first(first), second(second) {}
+  bool empty() const override { return first.empty() && second.empty(); }
+  const Process& top() const override { return next().top(); }
+  void pop() override { next().pop(); }
+
+ private:
+  ArrivalFeed& next() const {
+    if (second.empty()) return first;
+    if (first.empty()) return second;
+    return second.top().arrival < first.top().arrival ? second : first;
+  }
+
+  ArrivalFeed& first;
+  ArrivalFeed& second;
+};
+
+// Receives each process as a scheduler completes it
+class CompletionSink {
+ public:
+  virtual ~CompletionSink() {}
+  virtual void complete(const Process& p) = 0;
+};
+
+// Keeps every completed process, in completion order
+class ListSink : public CompletionSink {
+ public:
+  void complete(const Process& p) override { processes.push_back(p); }
+
+  list<Process> processes;
+};
+
+// Passes each completed process on to two sinks
+class TeeSink : public CompletionSink {
+ public:
+  TeeSink(CompletionSink& first, CompletionSink& second) : first(first), second(second) {}
+  void complete(const Process& p) override {
+    first.complete(p);
+    second.complete(p);
+  }
+
+ private:
+  CompletionSink& first;
+  CompletionSink& second;
+};
+
 pqueue_arrival read_workload(string filename);
 void show_workload(pqueue_arrival workload);
 void show_processes(list<Process> processes);
@@ -57,6 +133,21 @@ void show_processes(list<Process> processes);
 const int TARGET_LATENCY = 20;      // Needed for dynamic time slice calculation
 const int MIN_GRANULARITY = 3;      // Minimum time slice
 const int NICE_0_WEIGHT = 1024;     // Standard weight for nice value 0
+const float IO_BONUS_FACTOR = 0.7;  // Share of io_ratio taken off an I/O-bound slice
+const int WAKEUP_GRANULARITY = 3;   // Lead in vruntime a new or woken task needs to preempt
+
+// CFS tunables, settable at runtime. Defaults are the constants above.
+struct CFSParams {
+  int target_latency = TARGET_LATENCY;
+  int min_granularity = MIN_GRANULARITY;
+  int nice_0_weight = NICE_0_WEIGHT;
+  float io_bonus_factor = IO_BONUS_FACTOR;
+  int wakeup_granularity = WAKEUP_GRANULARITY;  // Negative disables preemption in cfs()
+  // CPU burst of an I/O-bound task before it blocks for I/O in cfs(). 0 keeps
+  // the old model, where I/O only discounts vruntime and tasks never block.
+  // eevdf() and cfs_smp() ignore it and always use the discount.
+  int io_burst = 0;
+};
 
 #endif
 
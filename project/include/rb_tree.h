@@ -3,6 +3,7 @@
 #define RB_TREE_H
 
 #include "process.h"
+#include <vector>
 
 #define RED 0
 #define BLACK 1
@@ -13,57 +14,146 @@ enum rbtraversal {
     POSTORDER
 };
 
-struct RBNode {
-    Process process;
+// Only the ordering key, a task id and the tree links live in a node. The
+// rest of the process sits in the scheduler's side arrays, indexed by id, so
+// a tree walk touches 40 bytes per node instead of a whole Process. Node is
+// the concrete node type, so the links need no casts.
+template <typename Node>
+struct RBLinks {
+    int vruntime;
+    int id;
     bool is_red;
-    RBNode* parent;
-    RBNode* left;
-    RBNode* right;
+    Node* parent;
+    Node* left;
+    Node* right;
     
-    RBNode(Process p) : process(p), is_red(true), parent(nullptr), left(nullptr), right(nullptr) {}
+    RBLinks(int id, int vruntime)
+        : vruntime(vruntime), id(id), is_red(true), parent(nullptr), left(nullptr), right(nullptr) {}
 };
 
-class RBTree {
-private:
-    RBNode* nil;
-    RBNode* root;
+struct RBNode : RBLinks<RBNode> {
+    static const bool augmented = false;
+    
+    RBNode(int id, int vruntime) : RBLinks(id, vruntime) {}
+    void update() {}
+};
+
+// Node of an AugmentedRBTree: also a deadline and weight, and aggregates
+// over the subtree rooted here (72 bytes)
+struct AugRBNode : RBLinks<AugRBNode> {
+    static const bool augmented = true;
+    
+    int deadline;      // Virtual deadline
+    int weight;        // Load weight
+    int min_deadline;
+    int subtree_size;
+    long long subtree_weight;
+    int min_key;
+    int max_key;
+    
+    AugRBNode(int id, int vruntime, int deadline = 0, int weight = 1)
+        : RBLinks(id, vruntime), deadline(deadline), weight(weight), min_deadline(deadline),
+          subtree_size(1), subtree_weight(weight), min_key(vruntime), max_key(vruntime) {}
+    void update();  // Recompute the aggregates from the children's
+};
+
+// Red-black tree keyed on vruntime, equal keys in insertion order. Instantiated
+// in rb_tree.cpp for RBNode and AugRBNode; with the latter every rotation,
+// link and unlink also refreshes the aggregates up to the root.
+template <typename Node>
+class BasicRBTree {
+protected:
+    Node* nil;
+    Node* root;
+    Node* leftmost;  // Cached smallest-vruntime node, nil when empty
+    Node* free_list;  // Released nodes for reuse, chained through right
+    vector<Node*> id_index;  // id -> node (nullptr if absent), tree is keyed on vruntime
+    int count;
     
     // Helper functions for balancing
-    void rotateLeft(RBNode* x);
-    void rotateRight(RBNode* y);
-    void fixInsert(RBNode* node);
-    void fixDelete(RBNode* node);
+    void rotateLeft(Node* x);
+    void rotateRight(Node* y);
+    void fixInsert(Node* node);
+    void fixDelete(Node* node);
+    
+    // Recompute the aggregates of a node and all its ancestors
+    void propagate(Node* node);
     
     // Helper for deletion
-    void transplant(RBNode* u, RBNode* v);
-    RBNode* minimum(RBNode* node);
+    void transplant(Node* u, Node* v);
+    Node* minimum(Node* node);
+    Node* maximum(Node* node);
+    Node* successor(Node* node);
+    Node* predecessor(Node* node);
+    
+    // Attach/detach a node without touching the id index or the pool
+    void link(Node* z);
+    void unlink(Node* z);
+    
+    // Node pool. allocNode() sets only the key and id.
+    Node* allocNode(int id, int vruntime);
+    void freeNode(Node* node);
+    Node* insertNode(Node* z);  // Link a node from allocNode() and index it
     
     // Utility functions
-    void destroyTree(RBNode* node);
-    void printInorder(RBNode* node, int depth);
-    void applyInorder(RBNode* node, int (*func)(Process&, void*), void* cookie);
+    void destroyTree(Node* node);
+    void printInorder(Node* node, int depth);
+    void applyInorder(Node* node, int (*func)(Node&, void*), void* cookie);
 
 public:
-    RBTree();
-    ~RBTree();
+    BasicRBTree();
+    ~BasicRBTree();
     
     // Core operations
-    void insert(Process p);
-    Process findMin();  // Leftmost node (smallest vruntime)
-    bool remove(int pid);  // Remove process by pid
-    RBNode* search(int pid);  // Find node by pid
-    RBNode* searchHelper(RBNode* node, int pid);
+    // Ids are small non-negative task slots, e.g. from a TaskTable
+    Node* insert(int id, int vruntime);  // Returns a handle valid until the node is removed
+    int findMin();  // Id of the leftmost node (smallest vruntime), -1 if empty. O(1)
+    int popMin();  // Unlink the leftmost node and return its id
+    Node* minNode();  // Handle to the leftmost node, nil when empty
+    bool remove(int id);  // Remove by id
+    void remove(Node* node);  // Remove by handle, O(log n)
+    void requeue(Node* node, int new_vruntime);  // Re-key in place, no allocation
+    Node* search(int id);  // Find node by id, O(1). Returns nil if absent
     
     // Tree properties
     bool isEmpty();
+    int size();
     
     // Debug functions
     void print();
-    int apply(int (*func)(Process&, void*), void* cookie);
+    int apply(int (*func)(Node&, void*), void* cookie);
     
     // Prevent copying
-    RBTree(const RBTree&) = delete;
-    RBTree& operator=(const RBTree&) = delete;
+    BasicRBTree(const BasicRBTree&) = delete;
+    BasicRBTree& operator=(const BasicRBTree&) = delete;
+};
+
+typedef BasicRBTree<RBNode> RBTree;
+
+// Also keeps the size, total weight, smallest deadline and key range of every
+// subtree, at the cost of an extra walk to the root per update
+class AugmentedRBTree : public BasicRBTree<AugRBNode> {
+public:
+    AugmentedRBTree();
+    
+    // Sets the deadline and weight of every node, including ones reused
+    // from the pool
+    AugRBNode* insert(int id, int vruntime, int deadline = 0, int weight = 1);
+    using BasicRBTree::requeue;
+    void requeue(AugRBNode* node, int new_vruntime, int new_deadline);
+    
+    // The node with the earliest deadline among those with vruntime <=
+    // max_vruntime, leftmost on ties. O(log n), nil if none
+    AugRBNode* earliestDeadline(int max_vruntime);
+    
+    // Order statistics. All O(log n).
+    int rank(AugRBNode* node);  // Nodes ahead of this one in vruntime order, -1 for nil
+    AugRBNode* select(int k);  // Node with rank k, nil if out of range
+    long long weightUpTo(int vruntime);  // Total weight of nodes with key <= vruntime
+    AugRBNode* selectByWeight(long long w);  // First node whose weight prefix exceeds w, nil if none
+    long long totalWeight();
+    int minKey();  // Smallest and largest vruntime, INT_MAX and INT_MIN when empty
+    int maxKey();
 };
 
 #endif // RB_TREE_H
\ No newline at end of file
@@ -0,0 +1,203 @@
+#ifndef RUNQUEUE_H
+#define RUNQUEUE_H
+
+#include "rb_tree.h"
+#include "pairing_heap.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Runqueue backends for cfs<RunQueue>(). Each holds (task id, vruntime)
+// pairs and provides:
+//   void insert(int id, int vruntime)
+//   int minId(), int minVruntime()     peek at the leftmost task
+//   int popMin()                       remove it, returning its id
+//   void requeueMin(int vruntime)      re-key it after it has run
+//   int size(), bool isEmpty()
+//   vector<pair<int, int>> entries()   (id, vruntime) in service order
+// Equal vruntimes are served in the order they were inserted or requeued,
+// so every backend produces exactly the same schedule.
+
+// The red-black tree, with the running task re-keyed in place
+class RBTreeRunQueue {
+ public:
+  void insert(int id, int vruntime) { tree.insert(id, vruntime); }
+  int minId() { return tree.minNode()->id; }
+  int minVruntime() { return tree.minNode()->vruntime; }
+  int popMin() { return tree.popMin(); }
+  void requeueMin(int vruntime) { tree.requeue(tree.minNode(), vruntime); }
+  int size() { return tree.size(); }
+  bool isEmpty() { return tree.isEmpty(); }
+  vector<pair<int, int>> entries() {
+    vector<pair<int, int>> out;
+    tree.apply(collectEntry, &out);
+    return out;
+  }
+
+ private:
+  static int collectEntry(RBNode& node, void* out) {
+    ((vector<pair<int, int>>*)out)->push_back({node.id, node.vruntime});
+    return 0;
+  }
+
+  RBTree tree;
+};
+
+class PairingHeapRunQueue {
+ public:
+  void insert(int id, int vruntime) { heap.insert(id, vruntime); }
+  int minId() { return heap.minNode()->id; }
+  int minVruntime() { return heap.minNode()->vruntime; }
+  int popMin() { return heap.popMin(); }
+  void requeueMin(int vruntime) { heap.requeue(heap.minNode(), vruntime); }
+  int size() { return heap.size(); }
+  bool isEmpty() { return heap.isEmpty(); }
+  vector<pair<int, int>> entries() {
+    vector<pair<int, int>> out;
+    for (PairingNode* node : heap.nodesInOrder()) {
+      out.push_back({node->id, node->vruntime});
+    }
+    return out;
+  }
+
+ private:
+  PairingHeap heap;
+};
+
+struct RunQueueEntry {
+  int vruntime;
+  int id;
+  unsigned long long seq;  // Insert/requeue order, breaks vruntime ties
+
+  bool operator<(const RunQueueEntry& other) const {
+    return vruntime != other.vruntime ? vruntime < other.vruntime : seq < other.seq;
+  }
+};
+
+// Implicit D-ary min-heap in one array. A wider node means a shallower heap
+// and sibling keys that share cache lines; requeueing the minimum is a
+// single sift-down from the root.
+template <int D>
+class DaryHeapRunQueue {
+ public:
+  DaryHeapRunQueue() : next_seq(0) {}
+
+  void insert(int id, int vruntime) {
+    heap.push_back({vruntime, id, next_seq++});
+    siftUp(heap.size() - 1);
+  }
+  int minId() { return heap[0].id; }
+  int minVruntime() { return heap[0].vruntime; }
+  int popMin() {
+    int id = heap[0].id;
+    heap[0] = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) siftDown(0);
+    return id;
+  }
+  void requeueMin(int vruntime) {
+    heap[0].vruntime = vruntime;
+    heap[0].seq = next_seq++;
+    siftDown(0);
+  }
+  int size() { return heap.size(); }
+  bool isEmpty() { return heap.empty(); }
+  vector<pair<int, int>> entries() {
+    vector<RunQueueEntry> sorted = heap;
+    sort(sorted.begin(), sorted.end());
+    vector<pair<int, int>> out;
+    for (const RunQueueEntry& entry : sorted) {
+      out.push_back({entry.id, entry.vruntime});
+    }
+    return out;
+  }
+
+ private:
+  void siftUp(size_t i) {
+    RunQueueEntry entry = heap[i];
+    while (i > 0) {
+      size_t parent = (i - 1) / D;
+      if (!(entry < heap[parent])) break;
+      heap[i] = heap[parent];
+      i = parent;
+    }
+    heap[i] = entry;
+  }
+
+  void siftDown(size_t i) {
+    RunQueueEntry entry = heap[i];
+    size_t n = heap.size();
+    while (true) {
+      size_t first = i * D + 1;
+      if (first >= n) break;
+      size_t last = min(first + D, n);
+      size_t best = first;
+      for (size_t c = first + 1; c < last; c++) {
+        if (heap[c] < heap[best]) best = c;
+      }
+      if (!(heap[best] < entry)) break;
+      heap[i] = heap[best];
+      i = best;
+    }
+    heap[i] = entry;
+  }
+
+  vector<RunQueueEntry> heap;
+  unsigned long long next_seq;
+};
+
+// B+-tree with wide nodes: entries sit in sorted leaf arrays of up to
+// LEAF_SIZE, so finding the next task and most inserts stay within a couple
+// of cache lines. Deletion only ever happens at the leftmost leaf; emptied
+// nodes are unlinked but never merged, which keeps popMin cheap and the
+// height bounded by the largest size the queue has reached.
+class BTreeRunQueue {
+ public:
+  static const int LEAF_SIZE = 64;
+  static const int FANOUT = 32;
+
+  BTreeRunQueue();
+  ~BTreeRunQueue();
+
+  void insert(int id, int vruntime);
+  int minId() { return leftmost->entries[leftmost->start].id; }
+  int minVruntime() { return leftmost->entries[leftmost->start].vruntime; }
+  int popMin();
+  void requeueMin(int vruntime);
+  int size() { return count; }
+  bool isEmpty() { return count == 0; }
+  vector<pair<int, int>> entries();
+
+  BTreeRunQueue(const BTreeRunQueue&) = delete;
+  BTreeRunQueue& operator=(const BTreeRunQueue&) = delete;
+
+ private:
+  struct Node {
+    bool leaf;
+    int size;  // Live entries (leaf) or children (inner)
+  };
+  struct Leaf : Node {
+    int start;  // Entries [start, start + size) are live
+    RunQueueEntry entries[LEAF_SIZE];
+  };
+  struct Inner : Node {
+    RunQueueEntry keys[FANOUT - 1];  // keys[i] is the smallest entry under children[i + 1]
+    Node* children[FANOUT];
+  };
+
+  // Inserts below node; on a split returns the new right sibling and sets
+  // separator to its smallest entry
+  Node* insertInto(Node* node, const RunQueueEntry& entry, RunQueueEntry& separator);
+  void removeLeftmostLeaf();
+  void collect(Node* node, vector<pair<int, int>>& out);
+  void destroy(Node* node);
+
+  Node* root;
+  Leaf* leftmost;  // Holds the minimum entry
+  int count;
+  unsigned long long next_seq;
+};
+
+#endif // RUNQUEUE_H
@@ -2,20 +2,137 @@
 #define SCHEDULERS_H
 
 #include "process.h"
+#include <algorithm>
 #include <list>
+#include <vector>
+
+// Multi-core CFS configuration
+struct SMPConfig {
+  int num_cpus = 1;
+  int migration_cost = 1;     // Time a CPU loses before running a migrated process
+  int balance_interval = 10;  // Period of load balancing, 0 disables it
+};
+
+// Multilevel feedback queue configuration. Level 0 has the highest priority;
+// one quantum per level, so the quanta also set the number of levels.
+const int MLFQ_MAX_LEVELS = 64;
+
+struct MLFQConfig {
+  vector<int> quanta = {2, 4, 8};
+  int boost_interval = 100;  // Period of the priority boost, 0 disables it
+};
+
+// Cost model for switching a CPU from one process to another
+struct SwitchCost {
+  int per_switch = 0;    // Direct cost of every context switch
+  int cache_refill = 0;  // Extra cost when resuming a process whose cache state went cold
+};
+
+// Context-switch and wakeup accounting of one scheduler run
+struct SchedStats {
+  long switches = 0;
+  long dispatches = 0;   // Scheduling decisions, whether or not they switched
+  long switch_time = 0;  // CPU time spent switching
+  long busy_time = 0;    // CPU time spent running processes
+  int total_time = 0;    // Time of the last completion
+  long wakeups = 0;             // Tasks back from I/O that have since been dispatched
+  long wakeup_latency = 0;      // Summed time from wakeup to dispatch
+  int max_wakeup_latency = 0;
+  long preemptions = 0;         // Slices cut short by an arrival or wakeup
+
+  double switchesPerTime() const { return total_time > 0 ? (double)switches / total_time : 0.0; }
+  double switchOverhead() const {
+    long used = busy_time + switch_time;
+    return used > 0 ? (double)switch_time / used : 0.0;
+  }
+  double avgWakeupLatency() const { return wakeups > 0 ? (double)wakeup_latency / wakeups : 0.0; }
+};
+
+// Counts a switch whenever the process dispatched on a CPU differs from the
+// one that ran there last, and returns the time to charge for it
+class SwitchTracker {
+ public:
+  SwitchTracker(const SwitchCost& cost) : cost(cost), last_pid(-1) {}
+
+  // Call before first_run is set, so a resumed process can be told apart
+  int dispatch(const Process& p) {
+    int charge = 0;
+    stats.dispatches++;
+    if (last_pid != -1 && p.pid != last_pid) {
+      charge = cost.per_switch;
+      if (p.first_run != -1) charge += cost.cache_refill;
+      stats.switches++;
+      stats.switch_time += charge;
+    }
+    last_pid = p.pid;
+    return charge;
+  }
+  void account(int run_time) { stats.busy_time += run_time; }
+  void preempted() { stats.preemptions++; }
+  void wakeupLatency(int latency) {
+    stats.wakeups++;
+    stats.wakeup_latency += latency;
+    stats.max_wakeup_latency = max(stats.max_wakeup_latency, latency);
+  }
+  int lastPid() const { return last_pid; }
+  // Picks up the accounting of a checkpointed run
+  void resume(int pid, const SchedStats& saved) {
+    last_pid = pid;
+    stats = saved;
+  }
+  void finish(int time, SchedStats* out) {
+    stats.total_time = time;
+    if (out) *out = stats;
+  }
+
+  SchedStats stats;
+
+ private:
+  SwitchCost cost;
+  int last_pid;
+};
+
+// Per-CPU results of a multi-core CFS run
+struct SMPStats {
+  vector<int> busy_time;       // Time spent running processes
+  vector<int> migration_time;  // Time lost to migration cost
+  vector<int> migrations;      // Processes pulled onto this CPU
+  int total_time;
+};
 
 // Utility functions for displaying workloads and processes
 pqueue_arrival read_workload(string filename);
 void show_workload(pqueue_arrival workload);
 void show_processes(list<Process> processes);
+void show_cpu_stats(const SMPStats& stats);
+void show_switch_stats(const SchedStats& stats);
 
 // Scheduler implementations
-list<Process> stcf(pqueue_arrival workload);
-list<Process> rr(pqueue_arrival workload);
-list<Process> cfs(pqueue_arrival workload);
+// Schedulers hand each process to sink the moment it completes and charge
+// cost each time the running process changes
+void stcf(ArrivalFeed& workload, CompletionSink& sink, const SwitchCost& cost = SwitchCost(),
+          SchedStats* stats = nullptr);
+void rr(ArrivalFeed& workload, CompletionSink& sink, int quantum = 1, const SwitchCost& cost = SwitchCost(),
+        SchedStats* stats = nullptr);
+void mlfq(ArrivalFeed& workload, CompletionSink& sink, const MLFQConfig& config = MLFQConfig(),
+          const SwitchCost& cost = SwitchCost(), SchedStats* stats = nullptr);
+void cfs(ArrivalFeed& workload, CompletionSink& sink, const CFSParams& params = CFSParams(),
+         const SwitchCost& cost = SwitchCost(), SchedStats* stats = nullptr);
+// Earliest eligible virtual deadline first, the successor of CFS in Linux.
+// Uses the CFS weights and vruntime; min_granularity is the request size.
+void eevdf(ArrivalFeed& workload, CompletionSink& sink, const CFSParams& params = CFSParams(),
+           const SwitchCost& cost = SwitchCost(), SchedStats* stats = nullptr);
+// CFS over any runqueue backend from runqueue.h; the plain cfs() uses
+// RBTreeRunQueue. Instantiated in cfs.cpp for each backend.
+template <typename RunQueue>
+void cfs(ArrivalFeed& workload, CompletionSink& sink, const CFSParams& params = CFSParams(),
+         const SwitchCost& cost = SwitchCost(), SchedStats* stats = nullptr);
+void cfs_smp(ArrivalFeed& workload, CompletionSink& sink, SMPConfig config, SMPStats* smp_stats = nullptr,
+             const CFSParams& params = CFSParams(), const SwitchCost& cost = SwitchCost(),
+             SchedStats* stats = nullptr);
 
 // Helper function for CFS
-void updateVRuntime(Process& process, int time_slice);
+void updateVRuntime(Process& process, int time_slice, const CFSParams& params = CFSParams());
 
 #ifdef DEBUGMODE
 #define debug(msg) \
@@ -4,13 +4,30 @@
 #include "process.h"
 #include "schedulers.h"
 #include "metrics.h"
+#include "sweep.h"
+#include "generator.h"
+#include "cfs_engine.h"
 #include <map>
 #include <string>
 
 class Simulation {
 private:
-    pqueue_arrival workload;
+    vector<Process> workload;  // Sorted by arrival, shared read-only by every run
     map<string, list<Process>> results;
+    int rr_quantum = 1;
+    MLFQConfig mlfq_config;
+    SMPConfig smp_config;
+    CFSParams cfs_params;
+    SwitchCost switch_cost;
+    SMPStats smp_stats;
+    map<string, SchedStats> switch_stats;
+    
+    // Runs scheduler_type over any arrival source, false if the type is unknown
+    bool runFeed(ArrivalFeed& feed, CompletionSink& sink, string scheduler_type,
+                 SchedStats* stats = nullptr);
+    
+    // False, with an error, if snapshot was taken on another workload
+    bool matchesWorkload(const CFSSnapshot& snapshot);
 
 public:
     // Load processes from a file
@@ -19,8 +36,53 @@ public:
     // Generate a test workload programmatically
     void generateTestWorkload(int test_case);
     
-    // Run a specific scheduler
-    list<Process> runScheduler(string scheduler_type);
+    // Replace the workload with a synthetic one
+    void generateWorkload(const GeneratorConfig& config);
+    
+    // Sets the time quantum used by round robin
+    void setQuantum(int quantum);
+    
+    // Sets the levels, quanta and boost period of MLFQ
+    void setMLFQConfig(const MLFQConfig& config);
+    
+    // Sets the number of CPUs for multi-core CFS (1 disables it in comparisons)
+    void setCPUs(int num_cpus);
+    
+    // Sets the CFS tunables used by cfs and cfs_smp
+    void setCFSParams(const CFSParams& params);
+    
+    // Sets the context-switch cost model used by every scheduler
+    void setSwitchCost(const SwitchCost& cost);
+    
+    // Runs CFS once per configuration and writes a metrics table to output_file
+    // (stdout when empty)
+    void sweepCFS(const vector<CFSParams>& configs, string output_file = "");
+    
+    // Run a specific scheduler: stcf, rr, mlfq, cfs, eevdf, cfs_smp, or cfs on a chosen
+    // runqueue backend (cfs_rbtree, cfs_pairing, cfs_binheap, cfs_heap4, cfs_btree)
+    list<Process> runScheduler(string scheduler_type, SchedStats* stats = nullptr);
+    
+    // Run a scheduler straight off a workload file, parsing arrivals lazily
+    // instead of loading the whole trace first, and accumulate metrics online
+    OnlineMetrics streamScheduler(string scheduler_type, string filename);
+    
+    // Same, generating arrivals on the fly instead of reading them
+    OnlineMetrics streamScheduler(string scheduler_type, const GeneratorConfig& config);
+    
+    // Runs CFS over the loaded workload until time `until` and returns its
+    // full state, including metrics of the processes completed so far
+    CFSSnapshot checkpointCFS(int until);
+    
+    // Continues a checkpointed CFS run to the end. `extra` arrivals (pids are
+    // assigned here) are merged into the rest of the loaded workload, so one
+    // warm-up can be forked into many what-if scenarios. An extra arrival
+    // before the checkpoint time is clamped to it, so its turnaround and
+    // response are measured from when it could actually be admitted. A
+    // snapshot of a different workload is refused and yields no metrics.
+    OnlineMetrics resumeCFS(const CFSSnapshot& snapshot, const vector<Process>& extra = {});
+    
+    // Runs every scenario as its own fork of snapshot, in parallel
+    vector<OnlineMetrics> forkCFS(const CFSSnapshot& snapshot, const vector<vector<Process>>& scenarios);
     
     // Run all schedulers for comparison
     void compareSchedulers();
@@ -0,0 +1,34 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "process.h"
+#include <ostream>
+#include <vector>
+
+// Values to try for each CFS tunable. A grid sweep runs every combination; a
+// random search samples uniformly between the smallest and largest values.
+struct SweepGrid {
+  vector<int> target_latency = {TARGET_LATENCY};
+  vector<int> min_granularity = {MIN_GRANULARITY};
+  vector<int> nice_0_weight = {NICE_0_WEIGHT};
+  vector<float> io_bonus_factor = {IO_BONUS_FACTOR};
+};
+
+// Metrics of one CFS run
+struct SweepResult {
+  CFSParams params;
+  float turnaround;
+  float response;
+  float fairness;
+  float throughput;
+};
+
+vector<CFSParams> grid_configs(const SweepGrid& grid);
+vector<CFSParams> random_configs(const SweepGrid& grid, int samples, unsigned seed);
+
+// Runs cfs() once per configuration, spread over all cores
+vector<SweepResult> sweep_cfs(const vector<Process>& workload, const vector<CFSParams>& configs,
+                              int max_threads = 0);
+void write_sweep_table(const vector<SweepResult>& results, ostream& out);
+
+#endif // SWEEP_H
@@ -0,0 +1,67 @@
+#ifndef TASK_TABLE_H
+#define TASK_TABLE_H
+
+#include "process.h"
+#include <vector>
+
+using namespace std;
+
+// Fields the CFS loop reads on every slice. Everything else about a process
+// (pid, arrival, first_run, ...) is only touched at dispatch and completion
+// and stays in the cold Process record.
+struct SchedEntity {
+  int remaining;     // CPU time still needed
+  int weight;
+  double io_scale;   // Factor applied to the slice before charging vruntime
+  int burst_left;    // CPU time until the task blocks for I/O, 0 if it never does
+  int woke_at;       // Time of the last wakeup not yet followed by a dispatch, -1 if none
+  int sleep_vruntime;  // Key while blocked on I/O, when the runqueue does not hold it
+};
+
+inline SchedEntity make_entity(const Process& p, const CFSParams& params) {
+  SchedEntity se;
+  se.remaining = p.duration;
+  se.weight = p.weight;
+  se.io_scale = p.is_io_bound ? 1.0 - (p.io_ratio * params.io_bonus_factor) : 1.0;
+  se.burst_left = 0;
+  se.woke_at = -1;
+  se.sleep_vruntime = 0;
+  return se;
+}
+
+// Advances vruntime by the weighted, I/O-scaled run time
+inline void charge_vruntime(int& vruntime, const SchedEntity& se, int run_time, const CFSParams& params) {
+  float effective_slice = run_time * se.io_scale;
+  vruntime += (effective_slice * params.nice_0_weight) / se.weight;
+}
+
+// Dense task slots for the runqueue. Hot and cold halves live in parallel
+// arrays indexed by the same id; ids of completed tasks are reused.
+class TaskTable {
+ public:
+  int add(const Process& p, const CFSParams& params) {
+    int id;
+    if (free_ids.empty()) {
+      id = hot_data.size();
+      hot_data.push_back(make_entity(p, params));
+      cold_data.push_back(p);
+    } else {
+      id = free_ids.back();
+      free_ids.pop_back();
+      hot_data[id] = make_entity(p, params);
+      cold_data[id] = p;
+    }
+    return id;
+  }
+  void release(int id) { free_ids.push_back(id); }
+
+  SchedEntity& hot(int id) { return hot_data[id]; }
+  Process& cold(int id) { return cold_data[id]; }
+
+ private:
+  vector<SchedEntity> hot_data;
+  vector<Process> cold_data;
+  vector<int> free_ids;
+};
+
+#endif // TASK_TABLE_H
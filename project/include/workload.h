@@ -0,0 +1,128 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "process.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+ public:
+  MappedFile() : addr(nullptr), length(0) {}
+  ~MappedFile();
+
+  bool open(string filename);
+  const char* data() const { return (const char*)addr; }
+  size_t size() const { return length; }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+ private:
+  void* addr;
+  size_t length;
+};
+
+// Parses the next "arrival duration nice is_io_bound io_ratio" record out of
+// [cur, end) and advances cur past it. Returns false at end of input or on a
+// malformed record.
+bool parse_process(const char*& cur, const char* end, Process& p);
+
+// Sets weight from nice value
+void initializeWeight(Process& p);
+
+// FNV-1a over every input field of every process, in order. Checkpoints keep
+// it to recognise the workload they were taken on.
+uint64_t workload_checksum(const vector<Process>& processes);
+
+// Streams processes out of a memory-mapped text workload, parsing one record
+// each time the scheduler pops. Only the next pending arrival is held in
+// memory. Records are expected in arrival order; a record whose arrival goes
+// backwards is simply admitted as soon as it is read.
+class TextFeed : public ArrivalFeed {
+ public:
+  TextFeed() : cur(nullptr), end(nullptr), has_next(false), next_pid(1) {}
+
+  bool open(string filename);
+  bool empty() const override { return !has_next; }
+  const Process& top() const override { return next; }
+  void pop() override { advance(); }
+
+ private:
+  void advance();
+
+  MappedFile file;
+  const char* cur;
+  const char* end;
+  Process next;
+  bool has_next;
+  int next_pid;
+};
+
+// Binary workload format, version 1. A fixed header followed by one
+// fixed-width column per field, each column starting on an 8-byte boundary:
+//   int32 pid[count], int32 arrival[count], int32 duration[count],
+//   float io_ratio[count], int8 nice[count], uint8 is_io_bound[count]
+// Rows are pre-sorted in scheduler arrival order, so the file can be mapped
+// and fed to a scheduler without parsing or sorting. Native byte order.
+const char WORKLOAD_MAGIC[8] = {'S', 'C', 'H', 'E', 'D', 'W', 'L', '\0'};
+const uint32_t WORKLOAD_VERSION = 1;
+
+struct WorkloadHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t count;
+};
+
+// Mapped binary workload with random access to rows
+class BinaryWorkload {
+ public:
+  BinaryWorkload() : count(0) {}
+
+  bool open(string filename);
+  size_t size() const { return count; }
+  void get(size_t i, Process& p) const;
+
+ private:
+  MappedFile file;
+  size_t count;
+  const int32_t* pid;
+  const int32_t* arrival;
+  const int32_t* duration;
+  const float* io_ratio;
+  const int8_t* nice;
+  const uint8_t* is_io_bound;
+};
+
+// Streams rows of a binary workload in order
+class BinaryFeed : public ArrivalFeed {
+ public:
+  BinaryFeed() : next_row(0) {}
+
+  bool open(string filename);
+  bool empty() const override { return next_row >= workload.size(); }
+  const Process& top() const override { return next; }
+  void pop() override;
+
+ private:
+  BinaryWorkload workload;
+  size_t next_row;
+  Process next;
+};
+
+// True if the file starts with the binary workload magic
+bool is_binary_workload(string filename);
+
+// Loads either format into a vector sorted by arrival
+vector<Process> load_workload(string filename);
+
+// Writes processes, already in arrival order, in either format
+bool write_text_workload(const vector<Process>& processes, string filename);
+bool write_binary_workload(const vector<Process>& processes, string filename);
+
+// Converts a text workload into the binary format
+bool convert_workload(string text_file, string binary_file);
+
+#endif // WORKLOAD_H
@@ -2,22 +2,26 @@
 #include <queue>
 #include <vector>
 #include <iostream>
+#include <climits>
 
 using namespace std;
 
-list<Process> stcf(pqueue_arrival workload) {
-  list<Process> complete;        
-  list<Process> available;       
+// Time advances from event to event (arrival, completion) instead of one unit
+// per iteration, so runtime scales with the number of events. The runqueue is
+// a min-heap on remaining time, touched only at arrivals and preemptions.
+void stcf(ArrivalFeed& workload, CompletionSink& sink, const SwitchCost& cost, SchedStats* stats) {
+  pqueue_duration available;       
+  SwitchTracker switches(cost);
   int time;
   
-  if (workload.empty()) return complete;
+  if (workload.empty()) return;
   
   time = workload.top().arrival;
   
   while (!workload.empty() || !available.empty()) {
 
     while (!workload.empty() && workload.top().arrival <= time) {
-      available.push_front(workload.top());
+      available.push(workload.top());
       workload.pop();
     }
     
@@ -30,33 +34,41 @@ list<Process> stcf(pqueue_arrival workload) {
       }
     }
     
-    available.sort(DurationComparator());
-    
-    Process cur_proc = available.back();
-    available.pop_back();
+    Process cur_proc = available.top();
+    available.pop();
     
+    time += switches.dispatch(cur_proc);
     if(cur_proc.first_run == -1){
       cur_proc.first_run = time;
     }
-    time += 1;
-    cur_proc.duration -= 1;
+    
+    // Shortest job only changes at an arrival, so run until then or completion.
+    // An arrival during the switch itself is looked at straight away.
+    int run = cur_proc.duration;
+    if (!workload.empty()) {
+      run = max(0, min(run, workload.top().arrival - time));
+    }
+    switches.account(run);
+    time += run;
+    cur_proc.duration -= run;
     if(cur_proc.duration == 0){
       cur_proc.completion = time;  
-      complete.push_back(cur_proc);
+      sink.complete(cur_proc);
     }else{
-      available.push_front(cur_proc);
+      available.push(cur_proc);
     }
   }
   
-  return complete;
+  switches.finish(time, stats);
 }
 
-list<Process> rr(pqueue_arrival workload) {
-  list<Process> complete;        
+void rr(ArrivalFeed& workload, CompletionSink& sink, int quantum, const SwitchCost& cost, SchedStats* stats) {
   list<Process> available;       
+  SwitchTracker switches(cost);
   int time;
   
-  if (workload.empty()) return complete;
+  if (workload.empty()) return;
+  if (quantum < 1) quantum = 1;
   
   time = workload.top().arrival;
   
@@ -79,18 +91,42 @@ list<Process> rr(pqueue_arrival workload) {
     Process cur_proc = available.back();
     available.pop_back();
     
+    time += switches.dispatch(cur_proc);
     if(cur_proc.first_run == -1){
       cur_proc.first_run = time;
     }
-    time += 1;
-    cur_proc.duration -= 1;
+    
+    int run = min(quantum, cur_proc.duration);
+    if (available.empty()) {
+      // Nobody to switch to: keep the CPU for whole quanta until the quantum
+      // in which the next process arrives
+      if (workload.empty()) {
+        run = cur_proc.duration;
+      } else if (workload.top().arrival > time) {
+        int until_arrival = workload.top().arrival - time;
+        int quanta = (until_arrival + quantum - 1) / quantum;
+        run = min(cur_proc.duration, quanta * quantum);
+      }
+    }
+    switches.account(run);
+    
+    // Processes arriving during the slice queue ahead of the preempted one,
+    // those arriving exactly at its end queue behind it
+    int end = time + run;
+    while (!workload.empty() && workload.top().arrival < end) {
+      available.push_front(workload.top());
+      workload.pop();
+    }
+    
+    time = end;
+    cur_proc.duration -= run;
     if(cur_proc.duration == 0){
       cur_proc.completion = time;  
-      complete.push_back(cur_proc);
+      sink.complete(cur_proc);
     }else{
       available.push_front(cur_proc);
     }
   }
   
-  return complete;
-}
\ No newline at end of file
+  switches.finish(time, stats);
+}
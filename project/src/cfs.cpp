@@ -1,94 +1,329 @@
-#include "rb_tree.h"
+#include "runqueue.h"
 #include "process.h"
 #include "schedulers.h"
+#include "task_table.h"
+#include "cfs_engine.h"
+#include <algorithm>
+#include <cmath>
 
 // When updating vruntime for a process after it runs
-void updateVRuntime(Process& process, int time_slice) {
-    float effective_slice = time_slice;
-    
-    // If I/O-bound process => apply a scaling factor to simulate I/O benefit
-    if (process.is_io_bound) {
-        // Higher the io_ratio => smaller vruntime increment
-        float io_bonus_factor = 0.7;  // Configurable parameter
-        effective_slice = time_slice * (1.0 - (process.io_ratio * io_bonus_factor));
-    }
-    
-    // Calculate vruntime with the effective time slice
-    process.vruntime += (effective_slice * NICE_0_WEIGHT) / process.weight;
+void updateVRuntime(Process& process, int time_slice, const CFSParams& params) {
+    // I/O-bound processes get a smaller increment, scaled by io_ratio
+    charge_vruntime(process.vruntime, make_entity(process, params), time_slice, params);
 }
 
-list<Process> cfs(pqueue_arrival workload) {
-  list<Process> completed;
-  RBTree rb_tree;
-  int time = 0;
-  int min_vruntime = 0;
-  
-  int num_runnable = 0;  // rb_tree size
+template <typename RunQueue>
+CFSEngine<RunQueue>::CFSEngine(const CFSParams& params, const SwitchCost& cost)
+    : params(params), switches(cost), started(false), time(0), min_vruntime(0),
+      num_runnable(0), arrivals_consumed(0) {}
+
+// I/O wait after each CPU burst, so the task spends io_ratio of its time blocked
+static int io_wait(const Process& p, int burst) {
+  float ratio = min(p.io_ratio, 0.95f);
+  return max(1, (int)lround(burst * ratio / (1 - ratio)));
+}
+
+template <typename RunQueue>
+int CFSEngine<RunQueue>::admit(const Process& p) {
+  int id = tasks.add(p, params);
+  // Under the burst model I/O costs wall time instead of earning a discount
+  if (params.io_burst > 0 && p.is_io_bound && p.io_ratio > 0) {
+    SchedEntity& se = tasks.hot(id);
+    se.io_scale = 1.0;
+    se.burst_left = params.io_burst;
+  }
+  return id;
+}
+
+template <typename RunQueue>
+void CFSEngine<RunQueue>::block(int id, int vruntime) {
+  SchedEntity& se = tasks.hot(id);
+  se.burst_left = params.io_burst;
+  se.sleep_vruntime = vruntime;
+  sleepers.push({time + io_wait(tasks.cold(id), params.io_burst), id, EVENT_IO_COMPLETE});
+}
+
+// First processes have vruntime of 0. Consequent processes have base vruntime according to the most recent minimum vruntime.
+// Sleepers still hold vruntimes relative to min_vruntime, so it only restarts when nobody is left.
+template <typename RunQueue>
+int CFSEngine<RunQueue>::placeArrival() const {
+  return num_runnable == 0 && sleepers.empty() && early_wakeups.empty() ? 0 : min_vruntime;
+}
+
+// Sleeper credit as in place_entity(): however long the task slept, it comes
+// back at most half a latency period behind min_vruntime
+template <typename RunQueue>
+int CFSEngine<RunQueue>::placeWakeup(int id) {
+  return max(tasks.hot(id).sleep_vruntime, min_vruntime - params.target_latency / 2);
+}
+
+template <typename RunQueue>
+void CFSEngine<RunQueue>::wakeup(int id, int wake_time) {
+  tasks.hot(id).woke_at = wake_time;
+  runqueue.insert(id, placeWakeup(id));
+  num_runnable++;
+}
+
+// Adds every arrival and then every wakeup due by now to the runqueue
+template <typename RunQueue>
+void CFSEngine<RunQueue>::enqueueDue(ArrivalFeed& workload) {
+  auto enqueue_arrival = [&](const Process& p) {
+    int vruntime = placeArrival();
+    runqueue.insert(admit(p), vruntime);
+    num_runnable++;
+    arrivals_consumed++;
+  };
+  for (const Process& p : early_arrivals) {
+    enqueue_arrival(p);
+  }
+  early_arrivals.clear();
+  while (!workload.empty() && workload.top().arrival <= time) {
+    enqueue_arrival(workload.top());
+    workload.pop();
+  }
   
-  if(!workload.empty()) {
-    time = workload.top().arrival;
-  } else {
-    return completed;  
+  // Tasks whose I/O has completed
+  for (const Event& event : early_wakeups) {
+    wakeup(event.id, event.time);
+  }
+  early_wakeups.clear();
+  while (!sleepers.empty() && sleepers.top().time <= time) {
+    wakeup(sleepers.top().id, sleepers.top().time);
+    sleepers.pop();
+  }
+}
+
+// Wakeup preemption as in check_preempt_wakeup(): walks the arrivals and
+// wakeups due before the slice ends, and returns the time of the first whose
+// vruntime trails the running task's by more than the wakeup granularity,
+// scaled to the newcomer's weight. Returns end when nobody preempts. Events
+// looked at are set aside in early_arrivals and early_wakeups.
+template <typename RunQueue>
+int CFSEngine<RunQueue>::preemptionPoint(ArrivalFeed& workload, const SchedEntity& curr,
+                                         int start, int end) {
+  if (params.wakeup_granularity < 0) {
+    return end;
   }
   
-  while(num_runnable > 0 || !workload.empty()) {
-    // Add any newly arrived processes to the tree
-    while(!workload.empty() && workload.top().arrival <= time) {
-      Process new_proc = workload.top();
+  while (true) {
+    bool arrival = !workload.empty() && workload.top().arrival < end;
+    bool wakeup = !sleepers.empty() && sleepers.top().time < end;
+    if (!arrival && !wakeup) {
+      return end;
+    }
+    
+    int at, vruntime, weight;
+    if (arrival && (!wakeup || workload.top().arrival <= sleepers.top().time)) {
+      const Process& p = workload.top();
+      at = p.arrival;
+      vruntime = min_vruntime;  // Where it will be placed, curr being queued
+      weight = p.weight;
+      early_arrivals.push_back(p);
       workload.pop();
-      
-      // First processes have vruntime of 0. Consequent processes have base vruntime according to the most recent minimum vruntime.
-      if(num_runnable == 0) {
-        new_proc.vruntime = 0;
-      } else {
-        new_proc.vruntime = min_vruntime;
-      }
-      
-      rb_tree.insert(new_proc);
-      num_runnable++;  
+    } else {
+      const Event& event = sleepers.top();
+      at = event.time;
+      vruntime = placeWakeup(event.id);
+      weight = tasks.hot(event.id).weight;
+      early_wakeups.push_back(event);
+      sleepers.pop();
     }
     
-    // If no processes in tree, jump time to next arrival
-    if(num_runnable == 0 && !workload.empty()) {
-      time = workload.top().arrival;
+    // Anything already waiting when the slice began is checked after one
+    // unit of it, so every dispatch makes progress
+    at = max(at, start + 1);
+    if (at >= end) {
       continue;
     }
+    int curr_vruntime = min_vruntime;
+    charge_vruntime(curr_vruntime, curr, at - start, params);
+    long long granularity = (long long)params.wakeup_granularity * params.nice_0_weight / max(1, weight);
+    if (curr_vruntime - vruntime > granularity) {
+      return at;
+    }
+  }
+}
+
+template <typename RunQueue>
+bool CFSEngine<RunQueue>::run(ArrivalFeed& workload, CompletionSink& sink, int until) {
+  if (!started) {
+    if (workload.empty()) {
+      return true;
+    }
+    time = workload.top().arrival;
+    started = true;
+  }
+  
+  while(num_runnable > 0 || !workload.empty() || !sleepers.empty()) {
+    if (time >= until) {
+      return false;
+    }
     
-    // Calculate time slice based on number of runnable processes
-    int time_slice = max(TARGET_LATENCY / max(1, num_runnable), MIN_GRANULARITY);
+    // Add any newly arrived or woken processes to the runqueue
+    enqueueDue(workload);
     
-    // Skip if no runnable processes
+    // If no processes in runqueue, jump time to the next arrival or wakeup
     if (num_runnable == 0) {
+      time = workload.empty() ? INT_MAX : workload.top().arrival;
+      if (!sleepers.empty()) {
+        time = min(time, sleepers.top().time);
+      }
       continue;
     }
     
-    // Select process with minimum vruntime
-    Process cur_proc = rb_tree.findMin();
-    rb_tree.remove(cur_proc.pid);
-    num_runnable--;  // Decrement counter on removal
-    min_vruntime = cur_proc.vruntime;  // Update min_vruntime
+    // Calculate time slice based on number of runnable processes
+    int time_slice = max({params.target_latency / max(1, num_runnable), params.min_granularity, 1});
+    
+    // Select process with minimum vruntime. It stays in the runqueue while
+    // it runs and is re-keyed afterwards.
+    int cur = runqueue.minId();
+    SchedEntity& se = tasks.hot(cur);
+    min_vruntime = runqueue.minVruntime();  // Update min_vruntime
     
     // Record first run time if needed
+    Process& cur_proc = tasks.cold(cur);
+    time += switches.dispatch(cur_proc);
     if(cur_proc.first_run == -1) {
       cur_proc.first_run = time;
     }
+    if (se.woke_at != -1) {
+      switches.wakeupLatency(time - se.woke_at);
+      se.woke_at = -1;
+    }
     
-    // Run the process for its time slice or until completion
-    int actual_runtime = min(time_slice, cur_proc.duration);
+    // Run the process for its time slice, until completion, until it
+    // blocks for I/O, or until a newcomer preempts it
+    int actual_runtime = min(time_slice, se.remaining);
+    if (se.burst_left > 0) {
+      actual_runtime = min(actual_runtime, se.burst_left);
+    }
+    int preempt_at = preemptionPoint(workload, se, time, time + actual_runtime);
+    if (preempt_at < time + actual_runtime) {
+      actual_runtime = preempt_at - time;
+      switches.preempted();
+    }
+    switches.account(actual_runtime);
     time += actual_runtime;
-    cur_proc.duration -= actual_runtime;
+    se.remaining -= actual_runtime;
     
     // Check if process completed
-    if(cur_proc.duration == 0) {
+    if(se.remaining == 0) {
+      cur_proc.duration = 0;
+      cur_proc.vruntime = min_vruntime;
       cur_proc.completion = time;
-      completed.push_back(cur_proc);
+      sink.complete(cur_proc);
+      tasks.release(cur);
+      runqueue.popMin();
+      num_runnable--;
     } else {
-      // Update vruntime and reinsert into tree
-      updateVRuntime(cur_proc, actual_runtime);
-      rb_tree.insert(cur_proc);
-      num_runnable++;  
+      // Update vruntime and move the task to its new position, or off the
+      // runqueue if its burst is over
+      int vruntime = min_vruntime;
+      charge_vruntime(vruntime, se, actual_runtime, params);
+      if (se.burst_left > 0 && (se.burst_left -= actual_runtime) == 0) {
+        runqueue.popMin();
+        num_runnable--;
+        block(cur, vruntime);
+      } else {
+        runqueue.requeueMin(vruntime);
+      }
     }
+    
+    // Newcomers seen during the slice go in now, so that a pause never
+    // leaves them outside the runqueue
+    enqueueDue(workload);
   }
-  return completed;
+  
+  return true;
+}
+
+// Captures the runqueue in service order, with each task's remaining time
+template <typename RunQueue>
+CFSSnapshot CFSEngine<RunQueue>::snapshot() {
+  CFSSnapshot snapshot;
+  snapshot.started = started;
+  snapshot.time = time;
+  snapshot.min_vruntime = min_vruntime;
+  snapshot.arrivals_consumed = arrivals_consumed;
+  snapshot.last_pid = switches.lastPid();
+  snapshot.switch_stats = switches.stats;
+  
+  auto capture = [&](int id, int vruntime) {
+    const SchedEntity& se = tasks.hot(id);
+    TaskState state;
+    state.proc = tasks.cold(id);
+    state.proc.duration = se.remaining;
+    state.proc.vruntime = vruntime;
+    state.burst_left = se.burst_left;
+    state.woke_at = se.woke_at;
+    return state;
+  };
+  for (const pair<int, int>& entry : runqueue.entries()) {
+    snapshot.runnable.push_back(capture(entry.first, entry.second));
+  }
+  EventQueue queue = sleepers;
+  while (!queue.empty()) {
+    int id = queue.top().id;
+    TaskState state = capture(id, tasks.hot(id).sleep_vruntime);
+    state.wake_time = queue.top().time;
+    snapshot.sleeping.push_back(state);
+    queue.pop();
+  }
+  return snapshot;
+}
+
+// Meant for a freshly constructed engine. Reinserting in service order, and
+// sleepers in wakeup order, reproduces the original tie-breaking.
+template <typename RunQueue>
+void CFSEngine<RunQueue>::restore(const CFSSnapshot& snapshot) {
+  started = snapshot.started;
+  time = snapshot.time;
+  min_vruntime = snapshot.min_vruntime;
+  arrivals_consumed = snapshot.arrivals_consumed;
+  switches.resume(snapshot.last_pid, snapshot.switch_stats);
+  
+  auto admit_state = [&](const TaskState& state) {
+    int id = admit(state.proc);
+    tasks.hot(id).burst_left = state.burst_left;
+    tasks.hot(id).woke_at = state.woke_at;
+    return id;
+  };
+  for (const TaskState& state : snapshot.runnable) {
+    runqueue.insert(admit_state(state), state.proc.vruntime);
+  }
+  num_runnable = snapshot.runnable.size();
+  for (const TaskState& state : snapshot.sleeping) {
+    int id = admit_state(state);
+    tasks.hot(id).sleep_vruntime = state.proc.vruntime;
+    sleepers.push({state.wake_time, id, EVENT_IO_COMPLETE});
+  }
+}
+
+template class CFSEngine<RBTreeRunQueue>;
+template class CFSEngine<PairingHeapRunQueue>;
+template class CFSEngine<DaryHeapRunQueue<2>>;
+template class CFSEngine<DaryHeapRunQueue<4>>;
+template class CFSEngine<BTreeRunQueue>;
+
+template <typename RunQueue>
+void cfs(ArrivalFeed& workload, CompletionSink& sink, const CFSParams& params,
+         const SwitchCost& cost, SchedStats* stats) {
+  if (workload.empty()) {
+    return;
+  }
+  CFSEngine<RunQueue> engine(params, cost);
+  engine.run(workload, sink);
+  engine.finish(stats);
+}
+
+template void cfs<RBTreeRunQueue>(ArrivalFeed&, CompletionSink&, const CFSParams&, const SwitchCost&, SchedStats*);
+template void cfs<PairingHeapRunQueue>(ArrivalFeed&, CompletionSink&, const CFSParams&, const SwitchCost&, SchedStats*);
+template void cfs<DaryHeapRunQueue<2>>(ArrivalFeed&, CompletionSink&, const CFSParams&, const SwitchCost&, SchedStats*);
+template void cfs<DaryHeapRunQueue<4>>(ArrivalFeed&, CompletionSink&, const CFSParams&, const SwitchCost&, SchedStats*);
+template void cfs<BTreeRunQueue>(ArrivalFeed&, CompletionSink&, const CFSParams&, const SwitchCost&, SchedStats*);
+
+void cfs(ArrivalFeed& workload, CompletionSink& sink, const CFSParams& params,
+         const SwitchCost& cost, SchedStats* stats) {
+  cfs<RBTreeRunQueue>(workload, sink, params, cost, stats);
 }
 
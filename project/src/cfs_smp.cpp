@@ -0,0 +1,225 @@
+#include "rb_tree.h"
+#include "process.h"
+#include "schedulers.h"
+#include "task_table.h"
+#include "event_queue.h"
+#include <vector>
+#include <climits>
+#include <algorithm>
+
+// Per-CPU runqueue. The running process is taken out of the tree for the
+// length of its slice so that load balancing only ever moves waiting tasks.
+struct CPUState {
+  RBTree rb_tree;
+  int min_vruntime = 0;
+  long load = 0;            // Sum of weights of queued + running processes
+  bool running = false;
+  int curr = -1;            // Task id of the running process
+  int curr_vruntime = 0;
+  int run_time = 0;         // CPU time of the current slice
+  int pending_cost = 0;     // Migration cost charged before the next slice
+  SwitchTracker switches{SwitchCost()};
+};
+
+// Moves the leftmost waiting process of src onto dst, renormalizing its
+// vruntime against the destination's min_vruntime
+static void migrate(CPUState& src, CPUState& dst, int dst_id, TaskTable& tasks,
+                    const SMPConfig& config, SMPStats& stats) {
+  int vruntime = src.rb_tree.minNode()->vruntime;
+  int id = src.rb_tree.popMin();
+  int weight = tasks.hot(id).weight;
+  src.load -= weight;
+
+  vruntime = vruntime - src.min_vruntime + dst.min_vruntime;
+  if (vruntime < 0) vruntime = 0;
+
+  dst.rb_tree.insert(id, vruntime);
+  dst.load += weight;
+  dst.pending_cost += config.migration_cost;
+  stats.migrations[dst_id]++;
+}
+
+// Periodic balancing: keep moving a waiting process from the heaviest to the
+// lightest runqueue while doing so narrows the gap between them. Every move
+// strictly lowers the sum of squared loads, so this terminates.
+static void balance(vector<CPUState>& cpus, TaskTable& tasks, const SMPConfig& config, SMPStats& stats) {
+  while (true) {
+    int busiest = -1, idlest = 0;
+    for (int i = 0; i < (int)cpus.size(); i++) {
+      if (!cpus[i].rb_tree.isEmpty() && (busiest == -1 || cpus[i].load > cpus[busiest].load)) {
+        busiest = i;
+      }
+      if (cpus[i].load < cpus[idlest].load) {
+        idlest = i;
+      }
+    }
+    if (busiest == -1 || busiest == idlest) return;
+
+    long imbalance = cpus[busiest].load - cpus[idlest].load;
+    if (tasks.hot(cpus[busiest].rb_tree.findMin()).weight >= imbalance) return;
+
+    migrate(cpus[busiest], cpus[idlest], idlest, tasks, config, stats);
+  }
+}
+
+// Idle balancing: an idle CPU pulls one waiting process from the heaviest
+// runqueue that has one
+static void idle_balance(vector<CPUState>& cpus, int cpu, TaskTable& tasks, const SMPConfig& config, SMPStats& stats) {
+  int busiest = -1;
+  for (int i = 0; i < (int)cpus.size(); i++) {
+    if (i != cpu && !cpus[i].rb_tree.isEmpty() && (busiest == -1 || cpus[i].load > cpus[busiest].load)) {
+      busiest = i;
+    }
+  }
+  if (busiest != -1) {
+    migrate(cpus[busiest], cpus[cpu], cpu, tasks, config, stats);
+  }
+}
+
+void cfs_smp(ArrivalFeed& workload, CompletionSink& sink, SMPConfig config, SMPStats* stats_out,
+             const CFSParams& params, const SwitchCost& cost, SchedStats* switch_stats) {
+  int num_cpus = max(1, config.num_cpus);
+  vector<CPUState> cpus(num_cpus);
+  TaskTable tasks;  // Shared by all runqueues, so migration only moves the id
+  for (CPUState& cpu : cpus) {
+    cpu.switches = SwitchTracker(cost);
+  }
+
+  SMPStats stats;
+  stats.busy_time.assign(num_cpus, 0);
+  stats.migration_time.assign(num_cpus, 0);
+  stats.migrations.assign(num_cpus, 0);
+  stats.total_time = 0;
+
+  if (workload.empty()) {
+    if (stats_out) *stats_out = stats;
+    if (switch_stats) *switch_stats = SchedStats();
+    return;
+  }
+
+  int time = workload.top().arrival;
+  int next_balance = time + config.balance_interval;
+  EventQueue timers;  // Slice ends and the next balancing tick
+  if (config.balance_interval > 0) {
+    timers.push({next_balance, 0, EVENT_BALANCE});
+  }
+  int running = 0;  // CPUs in the middle of a slice
+  vector<int> ending;
+
+  while (true) {
+    // Retire slices that end now, in CPU order. A due balancing tick is
+    // picked up through next_balance below.
+    ending.clear();
+    while (!timers.empty() && timers.top().time <= time) {
+      if (timers.top().kind == EVENT_SLICE_END) {
+        ending.push_back(timers.top().id);
+      }
+      timers.pop();
+    }
+    sort(ending.begin(), ending.end());
+    for (int i : ending) {
+      CPUState& cpu = cpus[i];
+      cpu.running = false;
+      running--;
+
+      SchedEntity& se = tasks.hot(cpu.curr);
+      se.remaining -= cpu.run_time;
+      if (se.remaining == 0) {
+        Process& cur_proc = tasks.cold(cpu.curr);
+        cur_proc.duration = 0;
+        cur_proc.vruntime = cpu.curr_vruntime;
+        cur_proc.completion = time;
+        sink.complete(cur_proc);
+        cpu.load -= se.weight;
+        tasks.release(cpu.curr);
+      } else {
+        charge_vruntime(cpu.curr_vruntime, se, cpu.run_time, params);
+        cpu.rb_tree.insert(cpu.curr, cpu.curr_vruntime);
+      }
+    }
+
+    // Place new arrivals on the least loaded CPU. Like cfs(), arrivals are
+    // only picked up at a scheduling point, i.e. once some CPU is free.
+    while (running < num_cpus && !workload.empty() && workload.top().arrival <= time) {
+      int id = tasks.add(workload.top(), params);
+      workload.pop();
+
+      int target = 0;
+      for (int i = 1; i < num_cpus; i++) {
+        if (cpus[i].load < cpus[target].load) target = i;
+      }
+      CPUState& cpu = cpus[target];
+
+      // Same placement rule as cfs(), per runqueue
+      bool empty = cpu.rb_tree.isEmpty() && !cpu.running;
+      cpu.rb_tree.insert(id, empty ? 0 : cpu.min_vruntime);
+      cpu.load += tasks.hot(id).weight;
+    }
+
+    if (config.balance_interval > 0 && time >= next_balance) {
+      balance(cpus, tasks, config, stats);
+      next_balance = time - (time % config.balance_interval) + config.balance_interval;
+      timers.push({next_balance, 0, EVENT_BALANCE});
+    }
+
+    // Give every idle CPU its next slice
+    for (int i = 0; i < num_cpus; i++) {
+      CPUState& cpu = cpus[i];
+      if (cpu.running) continue;
+      if (cpu.rb_tree.isEmpty()) {
+        idle_balance(cpus, i, tasks, config, stats);
+      }
+      if (cpu.rb_tree.isEmpty()) continue;
+
+      int nr_running = cpu.rb_tree.size();
+      int time_slice = max({params.target_latency / nr_running, params.min_granularity, 1});
+
+      cpu.curr_vruntime = cpu.rb_tree.minNode()->vruntime;
+      cpu.curr = cpu.rb_tree.popMin();
+      cpu.min_vruntime = cpu.curr_vruntime;
+      Process& cur_proc = tasks.cold(cpu.curr);
+      int start = time + cpu.pending_cost + cpu.switches.dispatch(cur_proc);
+      if (cur_proc.first_run == -1) {
+        cur_proc.first_run = start;
+      }
+
+      cpu.run_time = min(time_slice, tasks.hot(cpu.curr).remaining);
+      cpu.switches.account(cpu.run_time);
+      timers.push({start + cpu.run_time, i, EVENT_SLICE_END});
+      cpu.running = true;
+      running++;
+      stats.busy_time[i] += cpu.run_time;
+      stats.migration_time[i] += cpu.pending_cost;
+      cpu.pending_cost = 0;
+    }
+
+    // Jump to the next event: slice end, arrival, or balancing tick. While
+    // every CPU is busy, arrivals wait for the next slice end, as in cfs().
+    // With no CPU busy there is nothing to balance, so the tick is skipped.
+    int next_time = INT_MAX;
+    if (running > 0) {
+      next_time = timers.top().time;
+    }
+    if (!workload.empty() && running < num_cpus) {
+      next_time = min(next_time, workload.top().arrival);
+    }
+    if (next_time == INT_MAX) break;
+    time = next_time;
+  }
+
+  stats.total_time = time;
+  if (stats_out) *stats_out = stats;
+  
+  // Switch accounting summed over all CPUs
+  if (switch_stats) {
+    SchedStats total;
+    for (CPUState& cpu : cpus) {
+      total.switches += cpu.switches.stats.switches;
+      total.dispatches += cpu.switches.stats.dispatches;
+      total.switch_time += cpu.switches.stats.switch_time;
+      total.busy_time += cpu.switches.stats.busy_time;
+    }
+    total.total_time = time;
+    *switch_stats = total;
+  }
+}
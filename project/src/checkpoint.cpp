@@ -0,0 +1,142 @@
+#include "cfs_engine.h"
+#include "binary_io.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+// Checkpoint file: magic, version, size and checksum of the workload it was
+// taken on, engine state, runnable tasks in runqueue
+// order, sleeping tasks in wakeup order, then the partial metrics. Native
+// byte order, like the binary workload format.
+static const char SNAPSHOT_MAGIC[8] = {'S', 'C', 'H', 'E', 'D', 'C', 'K', '\0'};
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+static void write_process(ostream& out, const Process& p) {
+  write_value(out, p.pid);
+  write_value(out, p.arrival);
+  write_value(out, p.first_run);
+  write_value(out, p.duration);
+  write_value(out, p.service);
+  write_value(out, p.completion);
+  write_value(out, p.nice_value);
+  write_value(out, p.vruntime);
+  write_value(out, p.weight);
+  write_value(out, p.is_io_bound);
+  write_value(out, p.io_ratio);
+}
+
+static bool read_process(istream& in, Process& p) {
+  return read_value(in, p.pid) && read_value(in, p.arrival) && read_value(in, p.first_run) &&
+         read_value(in, p.duration) && read_value(in, p.service) &&
+         read_value(in, p.completion) && read_value(in, p.nice_value) &&
+         read_value(in, p.vruntime) && read_value(in, p.weight) &&
+         read_value(in, p.is_io_bound) && read_value(in, p.io_ratio);
+}
+
+static void write_stats(ostream& out, const SchedStats& stats) {
+  write_value(out, stats.switches);
+  write_value(out, stats.dispatches);
+  write_value(out, stats.switch_time);
+  write_value(out, stats.busy_time);
+  write_value(out, stats.total_time);
+  write_value(out, stats.wakeups);
+  write_value(out, stats.wakeup_latency);
+  write_value(out, stats.max_wakeup_latency);
+  write_value(out, stats.preemptions);
+}
+
+static bool read_stats(istream& in, SchedStats& stats) {
+  return read_value(in, stats.switches) && read_value(in, stats.dispatches) &&
+         read_value(in, stats.switch_time) && read_value(in, stats.busy_time) &&
+         read_value(in, stats.total_time) && read_value(in, stats.wakeups) &&
+         read_value(in, stats.wakeup_latency) && read_value(in, stats.max_wakeup_latency) &&
+         read_value(in, stats.preemptions);
+}
+
+static void write_task(ostream& out, const TaskState& task) {
+  write_process(out, task.proc);
+  write_value(out, task.burst_left);
+  write_value(out, task.woke_at);
+  write_value(out, task.wake_time);
+}
+
+static bool read_task(istream& in, TaskState& task) {
+  return read_process(in, task.proc) && read_value(in, task.burst_left) &&
+         read_value(in, task.woke_at) && read_value(in, task.wake_time);
+}
+
+static void write_tasks(ostream& out, const vector<TaskState>& tasks) {
+  write_value(out, (uint64_t)tasks.size());
+  for (const TaskState& task : tasks) {
+    write_task(out, task);
+  }
+}
+
+static bool read_tasks(istream& in, vector<TaskState>& tasks) {
+  uint64_t count;
+  if (!read_value(in, count)) return false;
+  // Grow as records arrive, so a corrupt count fails at the end of the file
+  // instead of allocating up front
+  tasks.clear();
+  for (uint64_t i = 0; i < count; i++) {
+    TaskState task;
+    if (!read_task(in, task)) return false;
+    tasks.push_back(task);
+  }
+  return true;
+}
+
+bool save_snapshot(const CFSSnapshot& snapshot, string filename) {
+  ofstream out(filename, ios::binary);
+  if (!out.is_open()) {
+    cerr << "Error: Unable to open file" << filename << endl;
+    return false;
+  }
+
+  out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  write_value(out, SNAPSHOT_VERSION);
+  write_value(out, snapshot.workload_size);
+  write_value(out, snapshot.workload_checksum);
+  write_value(out, snapshot.started);
+  write_value(out, snapshot.time);
+  write_value(out, snapshot.min_vruntime);
+  write_value(out, snapshot.arrivals_consumed);
+  write_value(out, snapshot.last_pid);
+  write_stats(out, snapshot.switch_stats);
+
+  write_tasks(out, snapshot.runnable);
+  write_tasks(out, snapshot.sleeping);
+  snapshot.metrics.save(out);
+  return out.good();
+}
+
+bool load_snapshot(string filename, CFSSnapshot& snapshot) {
+  ifstream in(filename, ios::binary);
+  if (!in.is_open()) {
+    cerr << "Error: Unable to open file" << filename << endl;
+    return false;
+  }
+
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  uint32_t version;
+  if (!in.read(magic, sizeof(magic)) || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+      !read_value(in, version) || version != SNAPSHOT_VERSION) {
+    cerr << "Error: Unsupported checkpoint format in " << filename << endl;
+    return false;
+  }
+
+  bool ok = read_value(in, snapshot.workload_size) &&
+            read_value(in, snapshot.workload_checksum) && read_value(in, snapshot.started) && read_value(in, snapshot.time) &&
+            read_value(in, snapshot.min_vruntime) && read_value(in, snapshot.arrivals_consumed) &&
+            read_value(in, snapshot.last_pid) && read_stats(in, snapshot.switch_stats) &&
+            read_tasks(in, snapshot.runnable) && read_tasks(in, snapshot.sleeping) &&
+            snapshot.metrics.load(in);
+
+  if (!ok) {
+    cerr << "Error: Truncated checkpoint file " << filename << endl;
+  }
+  return ok;
+}
@@ -0,0 +1,110 @@
+#include "rb_tree.h"
+#include "process.h"
+#include "schedulers.h"
+#include "task_table.h"
+#include <algorithm>
+
+using namespace std;
+
+// Load-weighted average vruntime of the runqueue, V in the EEVDF paper. The
+// sum is kept relative to base so it stays small, as in Linux's
+// avg_vruntime(). A task is eligible (lag >= 0) when its vruntime is <= V.
+class AvgVruntime {
+ public:
+  void add(int vruntime, int weight) {
+    sum += (long long)weight * (vruntime - base);
+    load += weight;
+  }
+  void remove(int vruntime, int weight) {
+    sum -= (long long)weight * (vruntime - base);
+    load -= weight;
+  }
+  // Call with the smallest queued vruntime, which keeps sum non-negative
+  void rebase(int new_base) {
+    sum -= load * (new_base - base);
+    base = new_base;
+  }
+  // V rounded down; the last base when nothing is queued
+  int value() const { return load > 0 ? base + (int)(sum / load) : base; }
+
+ private:
+  int base = 0;
+  long long sum = 0;   // Sum of weight * (vruntime - base)
+  long long load = 0;  // Sum of weights
+};
+
+// Virtual length of one request: the slice scaled by the task's weight
+static int virtual_slice(const SchedEntity& se, int slice, const CFSParams& params) {
+  return max(1, (int)((long long)slice * params.nice_0_weight / se.weight));
+}
+
+// Earliest eligible virtual deadline first. Every task asks for requests of
+// min_granularity (Linux's base_slice); among the tasks that are owed time,
+// the one whose current request would finish first in virtual time runs
+// next. The runqueue is keyed on vruntime and augmented with the minimum
+// deadline of each subtree, so that pick is O(log n).
+void eevdf(ArrivalFeed& workload, CompletionSink& sink, const CFSParams& params,
+           const SwitchCost& cost, SchedStats* stats) {
+  AugmentedRBTree runqueue;
+  TaskTable tasks;
+  AvgVruntime avg;
+  SwitchTracker switches(cost);
+  int slice = max(params.min_granularity, 1);
+
+  if (workload.empty()) return;
+
+  int time = workload.top().arrival;
+
+  while (!runqueue.isEmpty() || !workload.empty()) {
+    // New tasks start with zero lag: at V, with a full request ahead
+    while (!workload.empty() && workload.top().arrival <= time) {
+      int id = tasks.add(workload.top(), params);
+      workload.pop();
+      SchedEntity& se = tasks.hot(id);
+      int vruntime = avg.value();
+      runqueue.insert(id, vruntime, vruntime + virtual_slice(se, slice, params), se.weight);
+      avg.add(vruntime, se.weight);
+    }
+
+    if (runqueue.isEmpty()) {
+      time = workload.top().arrival;
+      continue;
+    }
+
+    // The leftmost task is always eligible, so a pick always succeeds
+    avg.rebase(runqueue.minNode()->vruntime);
+    AugRBNode* node = runqueue.earliestDeadline(avg.value());
+    int cur = node->id;
+    SchedEntity& se = tasks.hot(cur);
+    Process& cur_proc = tasks.cold(cur);
+
+    time += switches.dispatch(cur_proc);
+    if (cur_proc.first_run == -1) {
+      cur_proc.first_run = time;
+    }
+
+    // Serve one request, or what is left of the task
+    int run = min(slice, se.remaining);
+    switches.account(run);
+    time += run;
+    se.remaining -= run;
+
+    int vruntime = node->vruntime;
+    avg.remove(vruntime, se.weight);
+    if (se.remaining == 0) {
+      cur_proc.duration = 0;
+      cur_proc.vruntime = vruntime;
+      cur_proc.completion = time;
+      sink.complete(cur_proc);
+      runqueue.remove(node);
+      tasks.release(cur);
+    } else {
+      // Charge the request and ask for the next one
+      charge_vruntime(vruntime, se, run, params);
+      runqueue.requeue(node, vruntime, vruntime + virtual_slice(se, slice, params));
+      avg.add(vruntime, se.weight);
+    }
+  }
+
+  switches.finish(time, stats);
+}
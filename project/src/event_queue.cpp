@@ -0,0 +1,105 @@
+#include "event_queue.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+EventQueue::EventQueue() : buckets(MIN_BUCKETS), width(1), cur(0), bucket_end(1), count(0) {}
+
+void EventQueue::insert(const Event& event) {
+  Bucket& bucket = buckets[bucketOf(event.time)];
+  // Usually the latest event in its bucket, so this is an append
+  auto pos = upper_bound(bucket.events.begin() + bucket.head, bucket.events.end(), event,
+                         [](const Event& a, const Event& b) { return a.time < b.time; });
+  bucket.events.insert(pos, event);
+}
+
+void EventQueue::rewind(int time) {
+  cur = bucketOf(time);
+  bucket_end = ((long long)time / width + 1) * width;
+}
+
+void EventQueue::push(const Event& event) {
+  if (event.time < bucket_end - width) {
+    rewind(event.time);
+  }
+  insert(event);
+  count++;
+  if (count > 2 * (long)buckets.size()) {
+    resize(buckets.size() * 2);
+  }
+}
+
+void EventQueue::seek() {
+  int mask = buckets.size() - 1;
+  for (size_t scanned = 0; scanned < buckets.size(); scanned++) {
+    const Bucket& bucket = buckets[cur];
+    if (bucket.head < bucket.events.size() && bucket.events[bucket.head].time < bucket_end) {
+      return;
+    }
+    cur = (cur + 1) & mask;
+    bucket_end += width;
+  }
+
+  // Nothing due for a whole year: jump straight to the earliest event
+  int earliest = INT_MAX;
+  for (const Bucket& bucket : buckets) {
+    if (bucket.head < bucket.events.size()) {
+      earliest = min(earliest, bucket.events[bucket.head].time);
+    }
+  }
+  rewind(earliest);
+}
+
+const Event& EventQueue::top() {
+  seek();
+  const Bucket& bucket = buckets[cur];
+  return bucket.events[bucket.head];
+}
+
+void EventQueue::pop() {
+  seek();
+  Bucket& bucket = buckets[cur];
+  if (++bucket.head == bucket.events.size()) {
+    bucket.events.clear();
+    bucket.head = 0;
+  }
+  count--;
+  if (buckets.size() > MIN_BUCKETS && count < (long)buckets.size() / 2) {
+    resize(buckets.size() / 2);
+  }
+}
+
+void EventQueue::resize(int num_buckets) {
+  vector<Event> events;
+  events.reserve(count);
+  for (const Bucket& bucket : buckets) {
+    events.insert(events.end(), bucket.events.begin() + bucket.head, bucket.events.end());
+  }
+
+  // Width: three times the mean gap between the events nearest the front,
+  // which are the ones the next dequeues will walk over
+  const size_t SAMPLE = 25;
+  vector<int> times;
+  times.reserve(events.size());
+  for (const Event& event : events) {
+    times.push_back(event.time);
+  }
+  size_t sample = min(SAMPLE, times.size());
+  if (sample >= 2) {
+    nth_element(times.begin(), times.begin() + sample - 1, times.end());
+    sort(times.begin(), times.begin() + sample);
+    long long span = (long long)times[sample - 1] - times[0];
+    width = (int)max(1LL, min((long long)INT_MAX / 4, 3 * span / (long long)(sample - 1)));
+  }
+
+  // Events with equal times share a bucket and were collected in push
+  // order, so reinserting keeps them in that order
+  buckets.assign(num_buckets, Bucket());
+  for (const Event& event : events) {
+    insert(event);
+  }
+  if (!events.empty()) {
+    rewind(times[0]);
+  }
+}
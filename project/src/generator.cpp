@@ -0,0 +1,253 @@
+#include "generator.h"
+#include "parallel.h"
+#include "workload.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+// mt19937_64 and seed_seq are fully specified by the standard, unlike the
+// <random> distributions, so every variate below is derived by hand from raw
+// 64-bit draws to keep workloads identical across standard libraries.
+static double uniform(mt19937_64& rng) {
+  return 1.0 - (rng() >> 11) * 0x1.0p-53;  // (0, 1]
+}
+
+static double exponential(mt19937_64& rng, double mean) {
+  return -mean * log(uniform(rng));
+}
+
+static double normal(mt19937_64& rng) {
+  // Box-Muller
+  double u1 = uniform(rng);
+  double u2 = uniform(rng);
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int draw_duration(mt19937_64& rng, const GeneratorConfig& config) {
+  double x;
+  switch (config.durations) {
+    case DurationDistribution::EXPONENTIAL:
+      x = exponential(rng, config.mean_duration);
+      break;
+    case DurationDistribution::PARETO: {
+      // Scale chosen so the distribution has the requested mean
+      double alpha = max(config.duration_shape, 1.0 + 1e-6);
+      double scale = config.mean_duration * (alpha - 1.0) / alpha;
+      x = scale * pow(uniform(rng), -1.0 / alpha);
+      break;
+    }
+    case DurationDistribution::LOGNORMAL:
+    default: {
+      double sigma = config.duration_shape;
+      double mu = log(config.mean_duration) - sigma * sigma / 2.0;
+      x = exp(mu + sigma * normal(rng));
+      break;
+    }
+  }
+  x = min(x, (double)config.max_duration);
+  return max(1, (int)lround(x));
+}
+
+static int draw_nice(mt19937_64& rng, const GeneratorConfig& config) {
+  double total = 0;
+  for (const NiceShare& s : config.nice_mix) total += s.share;
+  if (total <= 0) return 0;
+
+  double pick = uniform(rng) * total;
+  for (const NiceShare& s : config.nice_mix) {
+    pick -= s.share;
+    if (pick <= 0) return s.nice_value;
+  }
+  return config.nice_mix.back().nice_value;
+}
+
+// Fills out[0..n) with chunk number `chunk` and times[0..n) with each
+// row's exact arrival time relative to the chunk start, in row order (which
+// is time order). Returns the time of the last arrival; the next chunk starts
+// there, so its first inter-arrival draw continues this chunk's process.
+static double generate_chunk(const GeneratorConfig& config, long chunk, Process* out,
+                             double* times, size_t n) {
+  seed_seq seq{(uint32_t)config.seed, (uint32_t)(config.seed >> 32),
+               (uint32_t)chunk, (uint32_t)(chunk >> 32)};
+  mt19937_64 rng(seq);
+
+  double rate = config.arrival_rate > 0 ? config.arrival_rate : 1.0;
+  double time = 0;
+  bool bursting = false;
+  for (size_t i = 0; i < n; i++) {
+    double current_rate = rate;
+    if (config.arrivals == ArrivalPattern::BURSTY) {
+      double flip = uniform(rng);
+      if (bursting ? flip <= config.burst_end_prob : flip <= config.burst_start_prob) {
+        bursting = !bursting;
+      }
+      if (bursting) current_rate *= config.burst_rate_factor;
+    }
+    time += exponential(rng, 1.0 / current_rate);
+    times[i] = time;
+
+    Process& p = out[i];
+    p.duration = draw_duration(rng, config);
+    p.service = p.duration;
+    p.first_run = -1;
+    p.completion = -1;
+    p.vruntime = 0;
+    p.nice_value = draw_nice(rng, config);
+    p.is_io_bound = uniform(rng) <= config.io_fraction;
+    p.io_ratio = p.is_io_bound
+        ? config.io_ratio_min + (float)uniform(rng) * (config.io_ratio_max - config.io_ratio_min)
+        : 0.0f;
+    initializeWeight(p);
+  }
+  return time;
+}
+
+// Same order the file loaders produce: ties on arrival go shortest first
+static bool arrives_before(const Process& a, const Process& b) {
+  return a.arrival != b.arrival ? a.arrival < b.arrival : a.duration < b.duration;
+}
+
+// Sets the arrivals of a generated chunk that starts at `offset` and sorts
+// it. Arrivals must fit an int, so rows past INT_MAX are dropped; returns how
+// many rows are kept.
+static size_t place_chunk(Process* out, const double* times, size_t n, double offset) {
+  size_t kept = 0;
+  for (; kept < n; kept++) {
+    double arrival = floor(offset + times[kept]);
+    if (arrival > INT_MAX) break;
+    out[kept].arrival = (int)arrival;
+  }
+  stable_sort(out, out + kept, arrives_before);
+  return kept;
+}
+
+static void warn_truncated(const GeneratorConfig& config, long kept) {
+  cerr << "Warning: arrivals past time " << INT_MAX << " dropped, generated " << kept
+       << " of " << config.count << " processes" << endl;
+}
+
+vector<Process> generate_workload(const GeneratorConfig& config, int max_threads) {
+  long count = max(0L, config.count);
+  long num_chunks = (count + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK;
+  vector<Process> processes(count);
+  vector<double> times(count);
+  vector<double> spans(num_chunks);
+
+  parallel_for(num_chunks, [&](int chunk) {
+    long begin = chunk * GENERATOR_CHUNK;
+    long n = min(GENERATOR_CHUNK, count - begin);
+    spans[chunk] = generate_chunk(config, chunk, &processes[begin], &times[begin], n);
+  }, max_threads);
+
+  // Chunks were generated from time 0; shift each to where the one before it
+  // ended
+  vector<double> offsets(num_chunks, 0);
+  for (long chunk = 1; chunk < num_chunks; chunk++) {
+    offsets[chunk] = offsets[chunk - 1] + spans[chunk - 1];
+  }
+  vector<size_t> kept(num_chunks);
+  parallel_for(num_chunks, [&](int chunk) {
+    long begin = chunk * GENERATOR_CHUNK;
+    long n = min(GENERATOR_CHUNK, count - begin);
+    kept[chunk] = place_chunk(&processes[begin], &times[begin], n, offsets[chunk]);
+  }, max_threads);
+
+  // Everything after the first chunk that ran past INT_MAX is dropped
+  for (long chunk = 0; chunk < num_chunks; chunk++) {
+    long begin = chunk * GENERATOR_CHUNK;
+    if ((long)kept[chunk] < min(GENERATOR_CHUNK, count - begin)) {
+      count = begin + kept[chunk];
+      num_chunks = chunk + 1;
+      processes.resize(count);
+      warn_truncated(config, count);
+      break;
+    }
+  }
+
+  // Chunks can share an arrival time at their boundary; re-sort those ties
+  long sorted_to = 0;
+  for (long chunk = 1; chunk < num_chunks; chunk++) {
+    long boundary = chunk * GENERATOR_CHUNK;
+    if (boundary >= count || boundary < sorted_to) continue;
+    int arrival = processes[boundary].arrival;
+    long lo = boundary, hi = boundary;
+    while (lo > 0 && processes[lo - 1].arrival == arrival) lo--;
+    while (hi < count && processes[hi].arrival == arrival) hi++;
+    if (lo < boundary) {
+      stable_sort(processes.begin() + lo, processes.begin() + hi, arrives_before);
+    }
+    sorted_to = hi;
+  }
+
+  parallel_for(num_chunks, [&](int chunk) {
+    long begin = chunk * GENERATOR_CHUNK;
+    long end = min(begin + GENERATOR_CHUNK, count);
+    for (long i = begin; i < end; i++) {
+      processes[i].pid = i + 1;
+    }
+  }, max_threads);
+  return processes;
+}
+
+GeneratorFeed::GeneratorFeed(const GeneratorConfig& config)
+    : config(config), next_chunk(0), time_offset(0), next_pid(1), next_row(0) {
+  fill();
+}
+
+void GeneratorFeed::fill() {
+  chunk.clear();
+  next_row = 0;
+  // A chunk may end up empty if it is one long tie held back for the next
+  do {
+    long begin = next_chunk * GENERATOR_CHUNK;
+    long n = max(0L, min(GENERATOR_CHUNK, config.count - begin));
+    if (n == 0) {
+      chunk.swap(held);
+      break;
+    }
+
+    vector<Process> rows(n);
+    vector<double> times(n);
+    double span = generate_chunk(config, next_chunk, rows.data(), times.data(), n);
+    size_t kept = place_chunk(rows.data(), times.data(), n, time_offset);
+    rows.resize(kept);
+    time_offset += span;
+    next_chunk++;
+    if ((long)kept < n) {
+      warn_truncated(config, begin + kept);
+      config.count = begin + kept;
+    }
+    bool last = begin + n >= config.count;
+
+    // Rows held back from the last chunk tie with the front of this one
+    if (!held.empty()) {
+      size_t ties = 0;
+      while (ties < rows.size() && rows[ties].arrival == held.back().arrival) ties++;
+      rows.insert(rows.begin(), held.begin(), held.end());
+      stable_sort(rows.begin(), rows.begin() + held.size() + ties, arrives_before);
+      held.clear();
+    }
+    // And this chunk's last arrival may tie with the front of the next
+    if (!last && !rows.empty()) {
+      size_t tail = rows.size();
+      while (tail > 0 && rows[tail - 1].arrival == rows.back().arrival) tail--;
+      held.assign(rows.begin() + tail, rows.end());
+      rows.resize(tail);
+    }
+    chunk.swap(rows);
+  } while (chunk.empty() && !held.empty());
+
+  for (Process& p : chunk) {
+    p.pid = next_pid++;
+  }
+}
+void GeneratorFeed::pop() {
+  next_row++;
+  if (next_row >= chunk.size()) {
+    fill();
+  }
+}
@@ -0,0 +1,82 @@
+#include "histogram.h"
+#include "binary_io.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+// One group of SUB_BUCKETS per power of two above the exact range
+static const int NUM_BUCKETS = (64 - LatencyHistogram::SUB_BUCKET_BITS + 1) * LatencyHistogram::SUB_BUCKETS;
+
+LatencyHistogram::LatencyHistogram()
+    : counts(NUM_BUCKETS, 0), total(0), min_value(LLONG_MAX), max_value(0), sum(0) {}
+
+int LatencyHistogram::bucketIndex(int64_t value) {
+  if (value < SUB_BUCKETS) {
+    return (int)value;
+  }
+  // Keep the top SUB_BUCKET_BITS + 1 bits of the value
+  int msb = 63 - __builtin_clzll((uint64_t)value);
+  int shift = msb - SUB_BUCKET_BITS;
+  int64_t top = value >> shift;  // In [SUB_BUCKETS, 2 * SUB_BUCKETS)
+  return (shift + 1) * SUB_BUCKETS + (int)(top - SUB_BUCKETS);
+}
+
+int64_t LatencyHistogram::bucketUpperBound(int index) {
+  if (index < SUB_BUCKETS) {
+    return index;
+  }
+  int shift = index / SUB_BUCKETS - 1;
+  int64_t lower = (int64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+  return lower + ((int64_t)1 << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t value) {
+  if (value < 0) value = 0;
+  counts[bucketIndex(value)]++;
+  total++;
+  min_value = std::min(min_value, value);
+  max_value = std::max(max_value, value);
+  sum += value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+  for (int i = 0; i < NUM_BUCKETS; i++) {
+    counts[i] += other.counts[i];
+  }
+  total += other.total;
+  min_value = std::min(min_value, other.min_value);
+  max_value = std::max(max_value, other.max_value);
+  sum += other.sum;
+}
+
+int64_t LatencyHistogram::percentile(double percentile) const {
+  if (total == 0) return 0;
+
+  // Nearest-rank: the smallest value with at least percentile% of samples at
+  // or below it, 1-based
+  uint64_t rank = (uint64_t)ceil(percentile * total / 100.0);
+  rank = std::max<uint64_t>(1, std::min(rank, total));
+
+  uint64_t seen = 0;
+  for (int i = 0; i < NUM_BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(bucketUpperBound(i), max_value);
+    }
+  }
+  return max_value;
+}
+
+void LatencyHistogram::save(ostream& out) const {
+  write_value(out, total);
+  write_value(out, min_value);
+  write_value(out, max_value);
+  write_value(out, sum);
+  out.write((const char*)counts.data(), counts.size() * sizeof(uint64_t));
+}
+
+bool LatencyHistogram::load(istream& in) {
+  return read_value(in, total) && read_value(in, min_value) && read_value(in, max_value) &&
+         read_value(in, sum) &&
+         in.read((char*)counts.data(), counts.size() * sizeof(uint64_t));
+}
@@ -1,5 +1,7 @@
 #include "process.h"
 #include "metrics.h"
+#include "schedulers.h"
+#include "binary_io.h"
 #include <fstream>
 #include <iostream>
 #include <list>
@@ -16,25 +18,25 @@
 using namespace std;
 
 // Calculates average turnaround time for list of processes
-float avg_turnaround(list<Process> processes) {
+float avg_turnaround(const list<Process>& processes) {
   float total_turnaround = 0;
-  for(Process proc : processes){
+  for(const Process& proc : processes){
     total_turnaround += (proc.completion - proc.arrival);
   }
   return total_turnaround / processes.size();
 }
 
 // Calculates average response time for list of processes
-float avg_response(list<Process> processes) {
+float avg_response(const list<Process>& processes) {
   float total_response = 0;
-  for(Process proc : processes){
+  for(const Process& proc : processes){
     total_response += (proc.first_run - proc.arrival);
   }
   return total_response / processes.size();
 }
 
 // Calculates how fairly CPU time is used for list of processes. Value closer to 1 means fairer distribution.
-float fairness_index(list<Process> processes){
+float fairness_index(const list<Process>& processes){
   if(processes.empty()) return 1.0;
 
   // Formula: (sum(allocation_ratio))² / (n * sum(allocation_ratio²))
@@ -72,8 +74,49 @@ float fairness_index(list<Process> processes){
   return (sum_ratios * sum_ratios) / (n * sum_squared_ratios);
 }
 
+LatencyHistogram turnaround_histogram(const list<Process>& processes) {
+  LatencyHistogram hist;
+  for (const Process& p : processes) {
+    hist.record(p.completion - p.arrival);
+  }
+  return hist;
+}
+
+LatencyHistogram response_histogram(const list<Process>& processes) {
+  LatencyHistogram hist;
+  for (const Process& p : processes) {
+    hist.record(p.first_run - p.arrival);
+  }
+  return hist;
+}
+
+LatencyHistogram wait_histogram(const list<Process>& processes) {
+  LatencyHistogram hist;
+  for (const Process& p : processes) {
+    hist.record(p.completion - p.arrival - p.service);
+  }
+  return hist;
+}
+
+// Displays p50/p95/p99/p99.9 of each latency
+void show_percentiles(const LatencyHistogram& response, const LatencyHistogram& turnaround,
+                      const LatencyHistogram& wait) {
+  const double percentiles[] = {50, 95, 99, 99.9};
+  cout << "Percentiles:\tp50\tp95\tp99\tp99.9\tmax" << endl;
+  auto row = [&](const char* name, const LatencyHistogram& hist) {
+    cout << name;
+    for (double p : percentiles) {
+      cout << "\t" << hist.percentile(p);
+    }
+    cout << "\t" << hist.max() << endl;
+  };
+  row("  Response", response);
+  row("  Turnaround", turnaround);
+  row("  Wait", wait);
+}
+
 // Measures how many processes the scheduler completes per unit of time
-float throughput(list<Process> processes, int total_time) {
+float throughput(const list<Process>& processes, int total_time) {
   if(processes.size() == 0 || total_time <= 0){
     return 0.0f;
   }
@@ -81,24 +124,264 @@ float throughput(list<Process> processes, int total_time) {
   return processes.size() / (float)total_time;
 }
 
-// Displays metrics of tests
-void show_metrics(list<Process> processes) {
-  float avg_t = avg_turnaround(processes);
-  float avg_r = avg_response(processes);
-  float fairness = fairness_index(processes);
-  
-  // Calculate total time (max completion time)
-  int total_time = 0;
+void CompletionColumns::complete(const Process& p) {
+  arrival.push_back(p.arrival);
+  first_run.push_back(p.first_run);
+  completion.push_back(p.completion);
+  service.push_back(p.service);
+  weight.push_back(p.weight);
+}
+
+void CompletionColumns::reserve(size_t n) {
+  arrival.reserve(n);
+  first_run.reserve(n);
+  completion.reserve(n);
+  service.reserve(n);
+  weight.reserve(n);
+}
+
+CompletionSpan CompletionColumns::span() const {
+  return {arrival.data(), first_run.data(), completion.data(), service.data(), weight.data(), size()};
+}
+
+CompletionColumns to_columns(const list<Process>& processes) {
+  CompletionColumns columns;
+  columns.reserve(processes.size());
   for (const Process& p : processes) {
-    total_time = max(total_time, p.completion);
+    columns.complete(p);
+  }
+  return columns;
+}
+
+MetricsSummary summarize(const CompletionSpan& span) {
+  // Each lane keeps its own partial sums, so there is no loop-carried
+  // dependency between neighbouring records and the inner loop maps onto
+  // vector registers. The body is branch-free (the turnaround guard is a
+  // select) and the fairness ratio divides by weight alone, as in
+  // OnlineMetrics, so no earlier pass for the total weight is needed. Records
+  // with zero turnaround are left out of the fairness population there too.
+  const size_t LANES = 4;
+  long long sum_turnaround[LANES] = {}, sum_response[LANES] = {};
+  double sum_ratio[LANES] = {}, sum_ratio_sq[LANES] = {};
+  long rated[LANES] = {};
+  int max_completion[LANES] = {};
+
+  auto accumulate = [&](size_t i, size_t lane) {
+    int turnaround = span.completion[i] - span.arrival[i];
+    int response = span.first_run[i] - span.arrival[i];
+    sum_turnaround[lane] += turnaround;
+    sum_response[lane] += response;
+    double share = turnaround > 0 ? (double)(turnaround - response) / turnaround : 0.0;
+    double ratio = share / span.weight[i];
+    rated[lane] += turnaround > 0;
+    sum_ratio[lane] += ratio;
+    sum_ratio_sq[lane] += ratio * ratio;
+    max_completion[lane] = max(max_completion[lane], span.completion[i]);
+  };
+
+  size_t n = span.size;
+  size_t i = 0;
+  for (; i + LANES <= n; i += LANES) {
+    for (size_t lane = 0; lane < LANES; lane++) {
+      accumulate(i + lane, lane);
+    }
   }
-  float throughput_val = throughput(processes, total_time);
+  for (; i < n; i++) {
+    accumulate(i, 0);
+  }
+
+  for (size_t lane = 1; lane < LANES; lane++) {
+    sum_turnaround[0] += sum_turnaround[lane];
+    sum_response[0] += sum_response[lane];
+    rated[0] += rated[lane];
+    sum_ratio[0] += sum_ratio[lane];
+    sum_ratio_sq[0] += sum_ratio_sq[lane];
+    max_completion[0] = max(max_completion[0], max_completion[lane]);
+  }
+
+  MetricsSummary summary;
+  summary.count = n;
+  if (n == 0) return summary;
+  summary.avg_turnaround = (double)sum_turnaround[0] / n;
+  summary.avg_response = (double)sum_response[0] / n;
+  if (rated[0] > 0 && sum_ratio_sq[0] > 0) {
+    summary.fairness = (sum_ratio[0] * sum_ratio[0]) / (rated[0] * sum_ratio_sq[0]);
+  }
+  summary.total_time = max_completion[0];
+  if (summary.total_time > 0) {
+    summary.throughput = n / (double)summary.total_time;
+  }
+  return summary;
+}
+
+void record_latencies(const CompletionSpan& span, LatencyHistogram& response,
+                      LatencyHistogram& turnaround, LatencyHistogram& wait) {
+  for (size_t i = 0; i < span.size; i++) {
+    int t = span.completion[i] - span.arrival[i];
+    turnaround.record(t);
+    response.record(span.first_run[i] - span.arrival[i]);
+    wait.record(t - span.service[i]);
+  }
+}
+
+// Welford update of a running mean and sum of squared deviations
+static void welford(long n, double x, double& mean, double& m2) {
+  double delta = x - mean;
+  mean += delta / n;
+  m2 += delta * (x - mean);
+}
+
+// Chan et al. combination of two partial Welford states
+static void welford_merge(long n_a, double& mean_a, double& m2_a, long n_b, double mean_b, double m2_b) {
+  long n = n_a + n_b;
+  double delta = mean_b - mean_a;
+  mean_a += delta * n_b / n;
+  m2_a += m2_b + delta * delta * n_a * n_b / n;
+}
+
+void OnlineMetrics::complete(const Process& p) {
+  n++;
+  int turnaround = p.completion - p.arrival;
+  int response = p.first_run - p.arrival;
+  welford(n, turnaround, mean_turnaround, m2_turnaround);
+  welford(n, response, mean_response, m2_response);
+  turnaround_hist.record(turnaround);
+  response_hist.record(response);
+  wait_hist.record(turnaround - p.service);
+
+  // Same allocation ratio as fairness_index(). Dividing by weight instead of
+  // weight / total_weight scales every ratio by the same constant, which
+  // Jain's index is invariant to, so the total weight is never needed.
+  // A process that never waited has no share to rate, so it is left out of
+  // the fairness population altogether
+  if (turnaround > 0) {
+    double actual_share = (double)(turnaround - response) / turnaround;
+    double ratio = actual_share / p.weight;
+    rated++;
+    sum_ratio += ratio;
+    sum_ratio_sq += ratio * ratio;
+  }
+
+  max_completion = max(max_completion, p.completion);
+}
+
+void OnlineMetrics::merge(const OnlineMetrics& other) {
+  if (other.n == 0) return;
+  if (n == 0) {
+    *this = other;
+    return;
+  }
+  welford_merge(n, mean_turnaround, m2_turnaround, other.n, other.mean_turnaround, other.m2_turnaround);
+  welford_merge(n, mean_response, m2_response, other.n, other.mean_response, other.m2_response);
+  n += other.n;
+  rated += other.rated;
+  sum_ratio += other.sum_ratio;
+  sum_ratio_sq += other.sum_ratio_sq;
+  max_completion = max(max_completion, other.max_completion);
+  turnaround_hist.merge(other.turnaround_hist);
+  response_hist.merge(other.response_hist);
+  wait_hist.merge(other.wait_hist);
+}
+
+void OnlineMetrics::save(ostream& out) const {
+  write_value(out, n);
+  write_value(out, mean_turnaround);
+  write_value(out, m2_turnaround);
+  write_value(out, mean_response);
+  write_value(out, m2_response);
+  write_value(out, rated);
+  write_value(out, sum_ratio);
+  write_value(out, sum_ratio_sq);
+  write_value(out, max_completion);
+  turnaround_hist.save(out);
+  response_hist.save(out);
+  wait_hist.save(out);
+}
+
+bool OnlineMetrics::load(istream& in) {
+  return read_value(in, n) && read_value(in, mean_turnaround) && read_value(in, m2_turnaround) &&
+         read_value(in, mean_response) && read_value(in, m2_response) &&
+         read_value(in, rated) && read_value(in, sum_ratio) && read_value(in, sum_ratio_sq) &&
+         read_value(in, max_completion) && turnaround_hist.load(in) &&
+         response_hist.load(in) && wait_hist.load(in);
+}
+
+double OnlineMetrics::fairnessIndex() const {
+  if (rated == 0 || sum_ratio_sq == 0) return 1.0;
+  return (sum_ratio * sum_ratio) / (rated * sum_ratio_sq);
+}
+
+double OnlineMetrics::throughput() const {
+  if (n == 0 || max_completion <= 0) return 0.0;
+  return n / (double)max_completion;
+}
+
+// Displays metrics accumulated online
+void show_metrics(const OnlineMetrics& metrics) {
+  cout << "Processes Completed:     " << metrics.count() << endl;
+  cout << "Average Turnaround Time: " << fixed << setprecision(2) << metrics.avgTurnaround()
+       << " (stddev " << sqrt(metrics.turnaroundVariance()) << ")" << endl;
+  cout << "Average Response Time:   " << fixed << setprecision(2) << metrics.avgResponse()
+       << " (stddev " << sqrt(metrics.responseVariance()) << ")" << endl;
+  cout << "Fairness Index:          " << fixed << setprecision(4) << metrics.fairnessIndex() << endl;
+  cout << "Throughput:              " << fixed << setprecision(4) << metrics.throughput()
+       << " processes/time unit" << endl;
+  show_percentiles(metrics.responseHistogram(), metrics.turnaroundHistogram(), metrics.waitHistogram());
+}
+
+// Displays metrics of tests
+void show_metrics(const list<Process>& processes) {
+  CompletionColumns columns = to_columns(processes);
+  MetricsSummary summary = summarize(columns.span());
+  LatencyHistogram response, turnaround, wait;
+  record_latencies(columns.span(), response, turnaround, wait);
   
   show_processes(processes);
   cout << '\n';
-  cout << "Average Turnaround Time: " << fixed << setprecision(2) << avg_t << endl;
-  cout << "Average Response Time:   " << fixed << setprecision(2) << avg_r << endl;
-  cout << "Fairness Index:          " << fixed << setprecision(4) << fairness << endl;
-  cout << "Throughput:              " << fixed << setprecision(4) << throughput_val 
+  cout << "Average Turnaround Time: " << fixed << setprecision(2) << summary.avg_turnaround << endl;
+  cout << "Average Response Time:   " << fixed << setprecision(2) << summary.avg_response << endl;
+  cout << "Fairness Index:          " << fixed << setprecision(4) << summary.fairness << endl;
+  cout << "Throughput:              " << fixed << setprecision(4) << summary.throughput 
        << " processes/time unit" << endl;
+  show_percentiles(response, turnaround, wait);
+}
+
+// Displays per-CPU utilization and migrations of a multi-core run
+void show_cpu_stats(const SMPStats& stats) {
+  ios_base::fmtflags flags = cout.flags();
+  streamsize precision = cout.precision();
+  cout << "CPU\tBusy\tMigr.Cost\tMigrations\tUtilization" << endl;
+  cout << "------------------------------------------------------------" << endl;
+  int total_migrations = 0;
+  for (size_t i = 0; i < stats.busy_time.size(); i++) {
+    float utilization = stats.total_time > 0 ? (float)stats.busy_time[i] / stats.total_time : 0.0f;
+    total_migrations += stats.migrations[i];
+    cout << i << "\t"
+         << stats.busy_time[i] << "\t"
+         << stats.migration_time[i] << "\t\t"
+         << stats.migrations[i] << "\t\t"
+         << fixed << setprecision(2) << utilization * 100 << "%" << endl;
+  }
+  cout << "Total Migrations:        " << total_migrations << endl;
+  cout.flags(flags);
+  cout.precision(precision);
+}
+
+// Displays context-switch counts and the CPU time they cost
+void show_switch_stats(const SchedStats& stats) {
+  ios_base::fmtflags flags = cout.flags();
+  streamsize precision = cout.precision();
+  cout << "Context Switches:        " << stats.switches
+       << " (" << fixed << setprecision(4) << stats.switchesPerTime() << " per time unit)" << endl;
+  cout << "CPU Lost to Switching:   " << fixed << setprecision(2) << stats.switchOverhead() * 100
+       << "% (" << stats.switch_time << " time units)" << endl;
+  if (stats.preemptions > 0) {
+    cout << "Preemptions:             " << stats.preemptions << endl;
+  }
+  if (stats.wakeups > 0) {
+    cout << "Wakeup Latency:          " << setprecision(2) << stats.avgWakeupLatency() << " avg, "
+         << stats.max_wakeup_latency << " max (" << stats.wakeups << " wakeups)" << endl;
+  }
+  cout.flags(flags);
+  cout.precision(precision);
 }
\ No newline at end of file
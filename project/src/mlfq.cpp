@@ -0,0 +1,111 @@
+#include "schedulers.h"
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <vector>
+
+using namespace std;
+
+struct MLFQTask {
+  Process proc;
+  int used;  // Time used of the current level's allotment
+};
+
+// Multilevel feedback queue. New processes enter the top level; a process
+// that uses up its level's quantum drops one level, and every boost_interval
+// all processes return to the top. Each level is a FIFO, and a bitmap of
+// non-empty levels makes picking the next process one find-first-set, as in
+// the O(1) Linux scheduler.
+void mlfq(ArrivalFeed& workload, CompletionSink& sink, const MLFQConfig& config,
+          const SwitchCost& cost, SchedStats* stats) {
+  int num_levels = max(1, min((int)config.quanta.size(), MLFQ_MAX_LEVELS));
+  vector<deque<MLFQTask>> levels(num_levels);
+  uint64_t bitmap = 0;  // Bit i is set while level i has a runnable process
+  SwitchTracker switches(cost);
+
+  auto quantum = [&](int level) {
+    return level < (int)config.quanta.size() ? max(1, config.quanta[level]) : 1;
+  };
+  auto push_back = [&](int level, const MLFQTask& task) {
+    levels[level].push_back(task);
+    bitmap |= 1ULL << level;
+  };
+  auto push_front = [&](int level, const MLFQTask& task) {
+    levels[level].push_front(task);
+    bitmap |= 1ULL << level;
+  };
+
+  if (workload.empty()) return;
+
+  int time = workload.top().arrival;
+  int next_boost = config.boost_interval > 0 ? time + config.boost_interval : INT_MAX;
+
+  while (!workload.empty() || bitmap != 0) {
+    while (!workload.empty() && workload.top().arrival <= time) {
+      push_back(0, {workload.top(), 0});
+      workload.pop();
+    }
+
+    // Priority boost: everything back to the top level, in priority order
+    if (time >= next_boost) {
+      for (int level = 1; level < num_levels; level++) {
+        for (const MLFQTask& task : levels[level]) {
+          levels[0].push_back(task);
+        }
+        levels[level].clear();
+      }
+      for (MLFQTask& task : levels[0]) {
+        task.used = 0;
+      }
+      bitmap = levels[0].empty() ? 0 : 1;
+      while (next_boost <= time) {
+        next_boost += config.boost_interval;
+      }
+    }
+
+    if (bitmap == 0) {
+      time = workload.top().arrival;
+      continue;
+    }
+
+    // Highest non-empty level
+    int level = __builtin_ctzll(bitmap);
+    MLFQTask task = levels[level].front();
+    levels[level].pop_front();
+    if (levels[level].empty()) {
+      bitmap &= ~(1ULL << level);
+    }
+
+    time += switches.dispatch(task.proc);
+    if (task.proc.first_run == -1) {
+      task.proc.first_run = time;
+    }
+
+    // Run out the allotment, unless a new arrival (which enters above this
+    // level) or the next boost cuts the slice short
+    int run = min(quantum(level) - task.used, task.proc.duration);
+    if (level > 0 && !workload.empty() && workload.top().arrival > time) {
+      run = min(run, workload.top().arrival - time);
+    }
+    if (next_boost > time && next_boost != INT_MAX) {
+      run = min(run, next_boost - time);
+    }
+    switches.account(run);
+    time += run;
+    task.proc.duration -= run;
+    task.used += run;
+
+    if (task.proc.duration == 0) {
+      task.proc.completion = time;
+      sink.complete(task.proc);
+    } else if (task.used >= quantum(level)) {
+      task.used = 0;
+      push_back(min(level + 1, num_levels - 1), task);
+    } else {
+      // Preempted with allotment left: resume first within its level
+      push_front(level, task);
+    }
+  }
+
+  switches.finish(time, stats);
+}
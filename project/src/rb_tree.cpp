@@ -1,24 +1,64 @@
 #include "rb_tree.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <climits>
 
-RBTree::RBTree() {
-    // Create nil node
-    nil = new RBNode(Process());
+void AugRBNode::update() {
+    min_deadline = std::min({deadline, left->min_deadline, right->min_deadline});
+    subtree_size = left->subtree_size + right->subtree_size + 1;
+    subtree_weight = left->subtree_weight + right->subtree_weight + weight;
+    min_key = std::min({vruntime, left->min_key, right->min_key});
+    max_key = std::max({vruntime, left->max_key, right->max_key});
+}
+
+template <typename Node>
+BasicRBTree<Node>::BasicRBTree() {
+    nil = new Node(-1, 0);
     nil->is_red = false;
     nil->left = nil->right = nil->parent = nil;
     
     // Create root
     root = nil;
+    leftmost = nil;
+    free_list = nullptr;
+    count = 0;
 }
 
-RBTree::~RBTree() {
+template <typename Node>
+BasicRBTree<Node>::~BasicRBTree() {
     destroyTree(root);
+    while (free_list != nullptr) {
+        Node* next = free_list->right;
+        delete free_list;
+        free_list = next;
+    }
     delete nil;
 }
 
-void RBTree::rotateLeft(RBNode* x) {
-    RBNode* y = x->right;
+template <typename Node>
+Node* BasicRBTree<Node>::allocNode(int id, int vruntime) {
+    if (free_list == nullptr) {
+        return new Node(id, vruntime);
+    }
+    
+    // Reuse a node released by an earlier remove()
+    Node* node = free_list;
+    free_list = node->right;
+    node->id = id;
+    node->vruntime = vruntime;
+    return node;
+}
+
+template <typename Node>
+void BasicRBTree<Node>::freeNode(Node* node) {
+    node->right = free_list;
+    free_list = node;
+}
+
+template <typename Node>
+void BasicRBTree<Node>::rotateLeft(Node* x) {
+    Node* y = x->right;
     
     // Turn y's left subtree into x's right subtree
     x->right = y->left;
@@ -39,10 +79,17 @@ void RBTree::rotateLeft(RBNode* x) {
     // Put x on y's left
     y->left = x;
     x->parent = y;
+    
+    // x is now below y
+    if (Node::augmented) {
+        x->update();
+        y->update();
+    }
 }
 
-void RBTree::rotateRight(RBNode* y) {
-    RBNode* x = y->left;
+template <typename Node>
+void BasicRBTree<Node>::rotateRight(Node* y) {
+    Node* x = y->left;
     
     // Turn x's right subtree into y's left subtree
     y->left = x->right;
@@ -63,12 +110,62 @@ void RBTree::rotateRight(RBNode* y) {
     // Put y on x's right
     x->right = y;
     y->parent = x;
+    
+    if (Node::augmented) {
+        y->update();
+        x->update();
+    }
+}
+
+template <typename Node>
+void BasicRBTree<Node>::propagate(Node* node) {
+    while (node != nil) {
+        node->update();
+        node = node->parent;
+    }
+}
+
+template <typename Node>
+Node* BasicRBTree<Node>::insert(int id, int vruntime) {
+    return insertNode(allocNode(id, vruntime));
+}
+
+template <typename Node>
+Node* BasicRBTree<Node>::insertNode(Node* z) {
+    link(z);
+    if (z->id >= (int)id_index.size()) {
+        id_index.resize(max(z->id + 1, (int)id_index.size() * 2), nullptr);
+    }
+    id_index[z->id] = z;
+    count++;
+    return z;
+}
+
+template <typename Node>
+void BasicRBTree<Node>::requeue(Node* node, int new_vruntime) {
+    node->vruntime = new_vruntime;
+    
+    // Key still sits between its neighbours => order is unchanged. Equal keys
+    // go after the predecessor, matching where insert() would place them.
+    Node* prev = predecessor(node);
+    Node* next = successor(node);
+    if ((prev == nil || prev->vruntime <= new_vruntime) &&
+        (next == nil || new_vruntime < next->vruntime)) {
+        if (Node::augmented) {
+            propagate(node);
+        }
+        return;
+    }
+    
+    unlink(node);
+    link(node);
 }
 
-void RBTree::insert(Process p) {
-    RBNode* z = new RBNode(p);
-    RBNode* y = nil;
-    RBNode* x = root;
+template <typename Node>
+void BasicRBTree<Node>::link(Node* z) {
+    Node* y = nil;
+    Node* x = root;
+    bool is_leftmost = true;
     
     z->left = nil;
     z->right = nil;
@@ -76,30 +173,41 @@ void RBTree::insert(Process p) {
     // Standard BST insertion
     while (x != nil) {
         y = x;
-        if (z->process.vruntime < x->process.vruntime) {
+        if (z->vruntime < x->vruntime) {
             x = x->left;
         } else {
             x = x->right;
+            is_leftmost = false;
         }
     }
     
     z->parent = y;
     if (y == nil) {
         root = z;  // Tree was empty
-    } else if (z->process.vruntime < y->process.vruntime) {
+    } else if (z->vruntime < y->vruntime) {
         y->left = z;
     } else {
         y->right = z;
     }
     
+    if (is_leftmost) {
+        leftmost = z;
+    }
+    
+    if (Node::augmented) {
+        z->update();
+        propagate(y);
+    }
+    
     z->is_red = true;
     fixInsert(z);
 }
 
-void RBTree::fixInsert(RBNode* z) {
+template <typename Node>
+void BasicRBTree<Node>::fixInsert(Node* z) {
     while (z->parent->is_red) {
         if (z->parent == z->parent->parent->left) {
-            RBNode* y = z->parent->parent->right;
+            Node* y = z->parent->parent->right;
             if (y->is_red) {
                 // Case 1: Uncle is red
                 z->parent->is_red = false;
@@ -118,7 +226,7 @@ void RBTree::fixInsert(RBNode* z) {
                 rotateRight(z->parent->parent);
             }
         } else {
-            RBNode* y = z->parent->parent->left;
+            Node* y = z->parent->parent->left;
             if (y->is_red) {
                 // Mirror Case 1
                 z->parent->is_red = false;
@@ -141,35 +249,35 @@ void RBTree::fixInsert(RBNode* z) {
     root->is_red = false;
 }
 
-Process RBTree::findMin() {
-    if (root == nil) {
-        return Process();  // Return empty process if tree is empty
-    }
-    
-    RBNode* current = root;
-    while (current->left != nil) {
-        current = current->left;
-    }
-    
-    return current->process;
+template <typename Node>
+int BasicRBTree<Node>::findMin() {
+    return leftmost->id;  // nil carries id -1
 }
 
-RBNode* RBTree::search(int pid) {
-    return searchHelper(root, pid);
+template <typename Node>
+Node* BasicRBTree<Node>::minNode() {
+    return leftmost;
 }
 
-RBNode* RBTree::searchHelper(RBNode* node, int pid) {
-    if (node == nil) return nil;
-    
-    if (node->process.pid == pid) return node;
-    
-    RBNode* leftResult = searchHelper(node->left, pid);
-    if (leftResult != nil) return leftResult;
+template <typename Node>
+int BasicRBTree<Node>::popMin() {
+    if (leftmost == nil) {
+        return -1;
+    }
     
-    return searchHelper(node->right, pid);
+    int id = leftmost->id;
+    remove(leftmost);
+    return id;
+}
+
+template <typename Node>
+Node* BasicRBTree<Node>::search(int id) {
+    if (id < 0 || id >= (int)id_index.size() || id_index[id] == nullptr) return nil;
+    return id_index[id];
 }
 
-void RBTree::transplant(RBNode* u, RBNode* v) {
+template <typename Node>
+void BasicRBTree<Node>::transplant(Node* u, Node* v) {
     if (u->parent == nil) {
         root = v;
     } else if (u == u->parent->left) {
@@ -180,21 +288,77 @@ void RBTree::transplant(RBNode* u, RBNode* v) {
     v->parent = u->parent;
 }
 
-RBNode* RBTree::minimum(RBNode* node) {
+template <typename Node>
+Node* BasicRBTree<Node>::minimum(Node* node) {
     while (node->left != nil) {
         node = node->left;
     }
     return node;
 }
 
-bool RBTree::remove(int pid) {
-    RBNode* z = search(pid);
+template <typename Node>
+Node* BasicRBTree<Node>::maximum(Node* node) {
+    while (node->right != nil) {
+        node = node->right;
+    }
+    return node;
+}
+
+template <typename Node>
+Node* BasicRBTree<Node>::successor(Node* node) {
+    if (node->right != nil) {
+        return minimum(node->right);
+    }
+    Node* p = node->parent;
+    while (p != nil && node == p->right) {
+        node = p;
+        p = p->parent;
+    }
+    return p;
+}
+
+template <typename Node>
+Node* BasicRBTree<Node>::predecessor(Node* node) {
+    if (node->left != nil) {
+        return maximum(node->left);
+    }
+    Node* p = node->parent;
+    while (p != nil && node == p->left) {
+        node = p;
+        p = p->parent;
+    }
+    return p;
+}
+
+template <typename Node>
+bool BasicRBTree<Node>::remove(int id) {
+    Node* z = search(id);
     if (z == nil) {
         return false;  // Process not found
     }
     
-    RBNode* y = z;
-    RBNode* x;
+    remove(z);
+    return true;
+}
+
+template <typename Node>
+void BasicRBTree<Node>::remove(Node* z) {
+    id_index[z->id] = nullptr;
+    count--;
+    unlink(z);
+    freeNode(z);
+}
+
+template <typename Node>
+void BasicRBTree<Node>::unlink(Node* z) {
+    // Leftmost has no left child, so its successor is either the minimum
+    // of its right subtree or its parent
+    if (z == leftmost) {
+        leftmost = (z->right != nil) ? minimum(z->right) : z->parent;
+    }
+    
+    Node* y = z;
+    Node* x;
     bool y_original_is_red = y->is_red;
     
     if (z->left == nil) {
@@ -220,19 +384,21 @@ bool RBTree::remove(int pid) {
         y->is_red = z->is_red;
     }
     
-    delete z;
+    // Everything from x's new parent up has lost z
+    if (Node::augmented) {
+        propagate(x->parent);
+    }
     
     if (!y_original_is_red) {
         fixDelete(x);
     }
-    
-    return true;
 }
 
-void RBTree::fixDelete(RBNode* x) {
+template <typename Node>
+void BasicRBTree<Node>::fixDelete(Node* x) {
     while (x != root && !x->is_red) {
         if (x == x->parent->left) {
-            RBNode* w = x->parent->right;
+            Node* w = x->parent->right;
             if (w->is_red) {
                 // Case 1: x's sibling w is red
                 w->is_red = false;
@@ -261,7 +427,7 @@ void RBTree::fixDelete(RBNode* x) {
             }
         } else {
             // Mirror cases
-            RBNode* w = x->parent->left;
+            Node* w = x->parent->left;
             if (w->is_red) {
                 w->is_red = false;
                 x->parent->is_red = true;
@@ -289,11 +455,18 @@ void RBTree::fixDelete(RBNode* x) {
     x->is_red = false;
 }
 
-bool RBTree::isEmpty() {
+template <typename Node>
+bool BasicRBTree<Node>::isEmpty() {
     return root == nil;
 }
 
-void RBTree::destroyTree(RBNode* node) {
+template <typename Node>
+int BasicRBTree<Node>::size() {
+    return count;
+}
+
+template <typename Node>
+void BasicRBTree<Node>::destroyTree(Node* node) {
     if (node != nil) {
         destroyTree(node->left);
         destroyTree(node->right);
@@ -301,7 +474,8 @@ void RBTree::destroyTree(RBNode* node) {
     }
 }
 
-void RBTree::print() {
+template <typename Node>
+void BasicRBTree<Node>::print() {
     if (root == nil) {
         std::cout << "Tree is empty" << std::endl;
         return;
@@ -312,20 +486,22 @@ void RBTree::print() {
     std::cout << std::endl;
 }
 
-void RBTree::printInorder(RBNode* node, int depth) {
+template <typename Node>
+void BasicRBTree<Node>::printInorder(Node* node, int depth) {
     if (node != nil) {
         printInorder(node->right, depth + 1);
         
         std::cout << std::setw(4 * depth) << "";
-        std::cout << "PID: " << node->process.pid 
-                  << " VT: " << node->process.vruntime 
+        std::cout << "ID: " << node->id 
+                  << " VT: " << node->vruntime 
                   << " (" << (node->is_red ? "RED" : "BLACK") << ")" << std::endl;
         
         printInorder(node->left, depth + 1);
     }
 }
 
-int RBTree::apply(int (*func)(Process&, void*), void* cookie) {
+template <typename Node>
+int BasicRBTree<Node>::apply(int (*func)(Node&, void*), void* cookie) {
     if (root == nil) {
         return 0;
     }
@@ -334,10 +510,153 @@ int RBTree::apply(int (*func)(Process&, void*), void* cookie) {
     return 0;
 }
 
-void RBTree::applyInorder(RBNode* node, int (*func)(Process&, void*), void* cookie) {
+template <typename Node>
+void BasicRBTree<Node>::applyInorder(Node* node, int (*func)(Node&, void*), void* cookie) {
     if (node != nil) {
         applyInorder(node->left, func, cookie);
-        func(node->process, cookie);
+        func(*node, cookie);
         applyInorder(node->right, func, cookie);
     }
-}
\ No newline at end of file
+}
+
+template class BasicRBTree<RBNode>;
+template class BasicRBTree<AugRBNode>;
+
+AugmentedRBTree::AugmentedRBTree() {
+    // nil's aggregates are those of an empty subtree
+    nil->deadline = INT_MAX;
+    nil->weight = 0;
+    nil->min_deadline = INT_MAX;
+    nil->subtree_size = 0;
+    nil->subtree_weight = 0;
+    nil->min_key = INT_MAX;
+    nil->max_key = INT_MIN;
+}
+
+AugRBNode* AugmentedRBTree::insert(int id, int vruntime, int deadline, int weight) {
+    AugRBNode* z = allocNode(id, vruntime);
+    z->deadline = deadline;
+    z->weight = weight;
+    return insertNode(z);
+}
+
+void AugmentedRBTree::requeue(AugRBNode* node, int new_vruntime, int new_deadline) {
+    node->deadline = new_deadline;
+    BasicRBTree::requeue(node, new_vruntime);
+}
+
+AugRBNode* AugmentedRBTree::earliestDeadline(int max_vruntime) {
+    AugRBNode* best = nil;  // Best single node seen on the way down...
+    AugRBNode* best_subtree = nil;  // ...or an eligible subtree holding a better deadline
+    int best_deadline = INT_MAX;
+    
+    // A node within max_vruntime has an entirely eligible left subtree,
+    // and its right subtree may hold more eligible nodes
+    AugRBNode* node = root;
+    while (node != nil) {
+        if (node->vruntime > max_vruntime) {
+            node = node->left;
+            continue;
+        }
+        if (node->left->min_deadline < best_deadline) {
+            best_deadline = node->left->min_deadline;
+            best_subtree = node->left;
+            best = nil;
+        }
+        if (node->deadline < best_deadline) {
+            best_deadline = node->deadline;
+            best_subtree = nil;
+            best = node;
+        }
+        node = node->right;
+    }
+    
+    // Find the leftmost node carrying the subtree's minimum
+    node = best_subtree;
+    while (node != nil) {
+        if (node->left->min_deadline == best_deadline) {
+            node = node->left;
+        } else if (node->deadline == best_deadline) {
+            return node;
+        } else {
+            node = node->right;
+        }
+    }
+    return best;
+}
+
+int AugmentedRBTree::rank(AugRBNode* node) {
+    if (node == nil) {
+        return -1;
+    }
+    
+    // Everything in the left subtree, plus each ancestor reached from the
+    // right together with its own left subtree
+    int k = node->left->subtree_size;
+    while (node->parent != nil) {
+        if (node == node->parent->right) {
+            k += node->parent->left->subtree_size + 1;
+        }
+        node = node->parent;
+    }
+    return k;
+}
+
+AugRBNode* AugmentedRBTree::select(int k) {
+    AugRBNode* node = root;
+    while (node != nil) {
+        int left_size = node->left->subtree_size;
+        if (k < left_size) {
+            node = node->left;
+        } else if (k == left_size) {
+            return node;
+        } else {
+            k -= left_size + 1;
+            node = node->right;
+        }
+    }
+    return nil;
+}
+
+long long AugmentedRBTree::weightUpTo(int vruntime) {
+    long long total = 0;
+    AugRBNode* node = root;
+    while (node != nil) {
+        if (node->vruntime <= vruntime) {
+            total += node->left->subtree_weight + node->weight;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return total;
+}
+
+AugRBNode* AugmentedRBTree::selectByWeight(long long w) {
+    AugRBNode* node = root;
+    while (node != nil) {
+        if (w < node->left->subtree_weight) {
+            node = node->left;
+            continue;
+        }
+        w -= node->left->subtree_weight;
+        if (w < node->weight) {
+            return node;
+        }
+        w -= node->weight;
+        node = node->right;
+    }
+    return nil;
+}
+
+long long AugmentedRBTree::totalWeight() {
+    return root->subtree_weight;
+}
+
+int AugmentedRBTree::minKey() {
+    return root->min_key;
+}
+
+int AugmentedRBTree::maxKey() {
+    return root->max_key;
+}
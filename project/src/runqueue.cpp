@@ -0,0 +1,213 @@
+#include "runqueue.h"
+#include <algorithm>
+
+using namespace std;
+
+BTreeRunQueue::BTreeRunQueue() : count(0), next_seq(0) {
+  leftmost = new Leaf();
+  leftmost->leaf = true;
+  leftmost->size = 0;
+  leftmost->start = 0;
+  root = leftmost;
+}
+
+BTreeRunQueue::~BTreeRunQueue() {
+  destroy(root);
+}
+
+void BTreeRunQueue::destroy(Node* node) {
+  if (!node->leaf) {
+    Inner* inner = static_cast<Inner*>(node);
+    for (int i = 0; i < inner->size; i++) {
+      destroy(inner->children[i]);
+    }
+    delete inner;
+  } else {
+    delete static_cast<Leaf*>(node);
+  }
+}
+
+BTreeRunQueue::Node* BTreeRunQueue::insertInto(Node* node, const RunQueueEntry& entry,
+                                               RunQueueEntry& separator) {
+  if (node->leaf) {
+    Leaf* leaf = static_cast<Leaf*>(node);
+    RunQueueEntry* begin = leaf->entries + leaf->start;
+    RunQueueEntry* end = begin + leaf->size;
+
+    if (leaf->size < LEAF_SIZE) {
+      // Slide the live entries back to the front once the tail is used up
+      if (leaf->start + leaf->size == LEAF_SIZE) {
+        copy(begin, end, leaf->entries);
+        leaf->start = 0;
+        begin = leaf->entries;
+        end = begin + leaf->size;
+      }
+      RunQueueEntry* pos = upper_bound(begin, end, entry);
+      copy_backward(pos, end, end + 1);
+      *pos = entry;
+      leaf->size++;
+      return nullptr;
+    }
+
+    // Full: split the entries plus the new one evenly over two leaves
+    RunQueueEntry all[LEAF_SIZE + 1];
+    RunQueueEntry* pos = upper_bound(begin, end, entry);
+    RunQueueEntry* out = copy(begin, pos, all);
+    *out++ = entry;
+    copy(pos, end, out);
+
+    int left_size = (LEAF_SIZE + 1) / 2;
+    Leaf* right = new Leaf();
+    right->leaf = true;
+    right->start = 0;
+    right->size = LEAF_SIZE + 1 - left_size;
+    copy(all + left_size, all + LEAF_SIZE + 1, right->entries);
+    copy(all, all + left_size, leaf->entries);
+    leaf->start = 0;
+    leaf->size = left_size;
+    separator = right->entries[0];
+    return right;
+  }
+
+  Inner* inner = static_cast<Inner*>(node);
+  int index = upper_bound(inner->keys, inner->keys + inner->size - 1, entry) - inner->keys;
+  RunQueueEntry child_separator;
+  Node* split = insertInto(inner->children[index], entry, child_separator);
+  if (split == nullptr) return nullptr;
+
+  if (inner->size < FANOUT) {
+    copy_backward(inner->keys + index, inner->keys + inner->size - 1, inner->keys + inner->size);
+    copy_backward(inner->children + index + 1, inner->children + inner->size,
+                  inner->children + inner->size + 1);
+    inner->keys[index] = child_separator;
+    inner->children[index + 1] = split;
+    inner->size++;
+    return nullptr;
+  }
+
+  // Full: split the children, pushing the middle key up
+  RunQueueEntry keys[FANOUT];
+  Node* children[FANOUT + 1];
+  copy(inner->keys, inner->keys + index, keys);
+  keys[index] = child_separator;
+  copy(inner->keys + index, inner->keys + FANOUT - 1, keys + index + 1);
+  copy(inner->children, inner->children + index + 1, children);
+  children[index + 1] = split;
+  copy(inner->children + index + 1, inner->children + FANOUT, children + index + 2);
+
+  int left_children = (FANOUT + 1) / 2;
+  Inner* right = new Inner();
+  right->leaf = false;
+  right->size = FANOUT + 1 - left_children;
+  copy(children + left_children, children + FANOUT + 1, right->children);
+  copy(keys + left_children, keys + FANOUT, right->keys);
+  inner->size = left_children;
+  copy(children, children + left_children, inner->children);
+  copy(keys, keys + left_children - 1, inner->keys);
+  separator = keys[left_children - 1];
+  return right;
+}
+
+void BTreeRunQueue::insert(int id, int vruntime) {
+  RunQueueEntry entry = {vruntime, id, next_seq++};
+  RunQueueEntry separator;
+  Node* split = insertInto(root, entry, separator);
+  if (split != nullptr) {
+    Inner* new_root = new Inner();
+    new_root->leaf = false;
+    new_root->size = 2;
+    new_root->children[0] = root;
+    new_root->children[1] = split;
+    new_root->keys[0] = separator;
+    root = new_root;
+  }
+  count++;
+}
+
+int BTreeRunQueue::popMin() {
+  int id = leftmost->entries[leftmost->start].id;
+  leftmost->start++;
+  leftmost->size--;
+  count--;
+
+  if (count == 0) {
+    // Only the path down to the leftmost leaf is left; start over
+    destroy(root);
+    leftmost = new Leaf();
+    leftmost->leaf = true;
+    leftmost->size = 0;
+    leftmost->start = 0;
+    root = leftmost;
+  } else if (leftmost->size == 0) {
+    removeLeftmostLeaf();
+  }
+  return id;
+}
+
+void BTreeRunQueue::requeueMin(int vruntime) {
+  // Still ahead of its neighbour in the leaf: re-key in place
+  RunQueueEntry& min_entry = leftmost->entries[leftmost->start];
+  if (leftmost->size > 1 && vruntime < leftmost->entries[leftmost->start + 1].vruntime) {
+    min_entry.vruntime = vruntime;
+    min_entry.seq = next_seq++;
+    return;
+  }
+  int id = popMin();
+  insert(id, vruntime);
+}
+
+vector<pair<int, int>> BTreeRunQueue::entries() {
+  vector<pair<int, int>> out;
+  collect(root, out);
+  return out;
+}
+
+void BTreeRunQueue::collect(Node* node, vector<pair<int, int>>& out) {
+  if (node->leaf) {
+    Leaf* leaf = static_cast<Leaf*>(node);
+    for (int i = leaf->start; i < leaf->start + leaf->size; i++) {
+      out.push_back({leaf->entries[i].id, leaf->entries[i].vruntime});
+    }
+    return;
+  }
+  Inner* inner = static_cast<Inner*>(node);
+  for (int i = 0; i < inner->size; i++) {
+    collect(inner->children[i], out);
+  }
+}
+
+// Unlinks the empty leftmost leaf and any inner nodes left without children
+void BTreeRunQueue::removeLeftmostLeaf() {
+  vector<Inner*> path;
+  Node* node = root;
+  while (!node->leaf) {
+    Inner* inner = static_cast<Inner*>(node);
+    path.push_back(inner);
+    node = inner->children[0];
+  }
+  delete static_cast<Leaf*>(node);
+
+  for (int level = (int)path.size() - 1; level >= 0; level--) {
+    Inner* inner = path[level];
+    copy(inner->children + 1, inner->children + inner->size, inner->children);
+    if (inner->size > 1) {
+      copy(inner->keys + 1, inner->keys + inner->size - 1, inner->keys);
+    }
+    inner->size--;
+    if (inner->size > 0) break;
+    delete inner;
+  }
+
+  // Drop roots left with a single child
+  while (!root->leaf && static_cast<Inner*>(root)->size == 1) {
+    Inner* old_root = static_cast<Inner*>(root);
+    root = old_root->children[0];
+    delete old_root;
+  }
+
+  node = root;
+  while (!node->leaf) {
+    node = static_cast<Inner*>(node)->children[0];
+  }
+  leftmost = static_cast<Leaf*>(node);
+}
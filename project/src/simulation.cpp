@@ -1,6 +1,9 @@
 #include "simulation.h"
 #include "metrics.h"
 #include "process.h"
+#include "parallel.h"
+#include "workload.h"
+#include "runqueue.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -15,122 +18,246 @@
 #include <climits>
 #include <cmath>
 #include <random>
+#include <chrono>
 
 using namespace std;
 
-const int nice_to_weight[40] = {
-  /* -20 */ 88761, 71755, 56483, 46273, 36291,
-  /* -15 */ 29154, 23254, 18705, 14949, 11916,
-  /* -10 */ 9548, 7620, 6100, 4904, 3906,
-  /*  -5 */ 3121, 2501, 1991, 1586, 1277,
-  /*   0 */ 1024, 820, 655, 526, 423,
-  /*   5 */ 335, 272, 215, 172, 137,
-  /*  10 */ 110, 87, 70, 56, 45,
-  /*  15 */ 36, 29, 23, 18, 15,
-};
-
-void initializeWeight(Process& p) {
-  // Convert nice value to index
-  int index = p.nice_value + 20;
-  
-  // Ensure index is within bounds
-  if (index < 0) {
-      index = 0;
-  } else if (index >= 40) {
-      index = 39;
-  }
-  
-  // Assign weight from lookup table
-  p.weight = nice_to_weight[index];
+// Loads custom file/test case
+bool Simulation::loadProcesses(string filename) {
+    // Text or binary, detected from the file header
+    workload = load_workload(filename);
+    return !workload.empty();
 }
 
-// Read workload from file
-pqueue_arrival read_workload(string filename) {
-  pqueue_arrival workload;
-  int next_pid = 1;
-  int NICE_0_WEIGHT = 1024;
+// Generates a synthetic workload
+void Simulation::generateWorkload(const GeneratorConfig& config) {
+    workload = generate_workload(config);
+}
 
-  ifstream file(filename);
-  if(!file.is_open()){
-    cerr << "Error: Unable to open file" << filename << endl;
-    return workload;
-  }
+// Generates a synthetic counterpart of each test in the test suite, scaled
+// up. Each case has a fixed seed so repeated runs see the same workload.
+void Simulation::generateTestWorkload(int test_case) {
+    GeneratorConfig config;  // Mean duration 20, so rate 0.04 keeps one CPU ~80% busy
+    config.seed = test_case;
+    
+    switch (test_case) {
+        case 1:  // Fairness: steady arrivals across the whole nice range
+            config.count = 1000;
+            config.arrival_rate = 0.04;
+            config.durations = DurationDistribution::EXPONENTIAL;
+            config.nice_mix = {{-10, 1}, {-5, 1}, {0, 1}, {5, 1}, {10, 1}};
+            break;
+        case 2:  // Dynamic: bursty arrivals and departures
+            config.count = 10000;
+            config.arrivals = ArrivalPattern::BURSTY;
+            config.arrival_rate = 0.035;  // ~10% of arrivals come in 10x bursts
+            break;
+        case 3:  // Half I/O-bound, half CPU-bound
+            config.count = 10000;
+            config.arrival_rate = 0.04;
+            config.io_fraction = 0.5;
+            config.io_ratio_min = 0.6;
+            config.io_ratio_max = 0.9;
+            break;
+        case 4:  // Mostly low priority with a few high-priority short jobs
+            config.count = 10000;
+            config.arrival_rate = 0.04;
+            config.durations = DurationDistribution::LOGNORMAL;
+            config.duration_shape = 1.0;
+            config.nice_mix = {{10, 0.8}, {0, 0.15}, {-10, 0.05}};
+            break;
+        case 5:  // Scalability: a million heavy-tailed, mixed tasks
+            config.count = 1000000;
+            config.arrival_rate = 0.04;
+            config.nice_mix = {{-10, 1}, {-5, 2}, {0, 4}, {5, 2}, {10, 1}};
+            config.io_fraction = 0.3;
+            break;
+        default:
+            cout << "Invalid test number\n";
+            return;
+    }
+    
+    generateWorkload(config);
+}
 
-  string file_contents;
-  string line;
-  while(getline(file, line)){
-    file_contents += line + "\n";
-  }
-  file.close();
-
-  istringstream iss(file_contents);
-  int arrival, duration, nice_value, is_io_bound;
-  float io_ratio;
-
-  
-  while(iss >> arrival >> duration >> nice_value >> is_io_bound >> io_ratio) {
-    Process p;
-    p.pid = next_pid++;
-    p.arrival = arrival;
-    p.duration = duration;
-    p.first_run = -1;
-    p.completion = -1;
-    p.vruntime = 0;
-    p.nice_value = nice_value;
-    p.is_io_bound = is_io_bound;
-    p.io_ratio = io_ratio;
-
-    // int temp_nice_value = p.nice_value;
-    // if(temp_nice_value < -20){
-    //   temp_nice_value = -20;
-    // }
-    // if(temp_nice_value > 19){
-    //   temp_nice_value = 19;
-    // }
-    // p.weight = NICE_0_WEIGHT/pow(1.25,temp_nice_value);
-
-    // Considered the above approach, but could be a big efficiency suck as computing the power of tens of processes may slow processor. Settled on adding a matrix containing all pre-computed nice values.
-
-    // Ensure index is within bounds
-    int index = p.nice_value + 20; 
-    if (index < 0) {
-        index = 0;
-    } else if (index >= 40) {
-        index = 39;
-    }
-    
-    p.weight = nice_to_weight[index];
-
-    workload.push(p);
-  }
-  
-  return workload;
+// Sets round robin time quantum
+void Simulation::setQuantum(int quantum) {
+    rr_quantum = max(1, quantum);
 }
 
-// Loads custom file/test case
-bool Simulation::loadProcesses(string filename) {
-    workload = read_workload(filename);
-    return !workload.empty();
+// Sets MLFQ levels and boost period
+void Simulation::setMLFQConfig(const MLFQConfig& config) {
+    mlfq_config = config;
+}
+
+// Sets CPU count for multi-core CFS
+void Simulation::setCPUs(int num_cpus) {
+    smp_config.num_cpus = max(1, num_cpus);
+}
+
+// Sets CFS tunables
+void Simulation::setCFSParams(const CFSParams& params) {
+    cfs_params = params;
+}
+
+// Sets context-switch cost model
+void Simulation::setSwitchCost(const SwitchCost& cost) {
+    switch_cost = cost;
+}
+
+// Runs a parameter sweep of CFS over the loaded workload
+void Simulation::sweepCFS(const vector<CFSParams>& configs, string output_file) {
+    vector<SweepResult> sweep = sweep_cfs(workload, configs);
+    
+    if (output_file.empty()) {
+        write_sweep_table(sweep, cout);
+        return;
+    }
+    
+    ofstream out(output_file);
+    if (!out.is_open()) {
+        cerr << "Error: Unable to open file" << output_file << endl;
+        return;
+    }
+    write_sweep_table(sweep, out);
 }
 
 // Runs scheduler
-list<Process> Simulation::runScheduler(string scheduler_type) {
-    pqueue_arrival workload_copy = workload;
+list<Process> Simulation::runScheduler(string scheduler_type, SchedStats* stats) {
+    VectorFeed feed(workload);
+    ListSink sink;
+    runFeed(feed, sink, scheduler_type, stats);
+    return sink.processes;
+}
+
+// Runs scheduler over a file without loading it into the simulation. Only
+// running totals are kept, so memory does not grow with the trace.
+OnlineMetrics Simulation::streamScheduler(string scheduler_type, string filename) {
+    OnlineMetrics metrics;
+    
+    if (is_binary_workload(filename)) {
+        BinaryFeed feed;
+        if (feed.open(filename)) {
+            runFeed(feed, metrics, scheduler_type);
+        }
+        return metrics;
+    }
     
+    TextFeed feed;
+    if (feed.open(filename)) {
+        runFeed(feed, metrics, scheduler_type);
+    }
+    return metrics;
+}
+
+OnlineMetrics Simulation::streamScheduler(string scheduler_type, const GeneratorConfig& config) {
+    OnlineMetrics metrics;
+    GeneratorFeed feed(config);
+    runFeed(feed, metrics, scheduler_type);
+    return metrics;
+}
+
+CFSSnapshot Simulation::checkpointCFS(int until) {
+    VectorFeed feed(workload);
+    OnlineMetrics metrics;
+    CFSEngine<RBTreeRunQueue> engine(cfs_params, switch_cost);
+    engine.run(feed, metrics, until);
+    
+    CFSSnapshot snapshot = engine.snapshot();
+    snapshot.metrics = metrics;
+    snapshot.workload_size = workload.size();
+    snapshot.workload_checksum = workload_checksum(workload);
+    return snapshot;
+}
+
+bool Simulation::matchesWorkload(const CFSSnapshot& snapshot) {
+    if (snapshot.workload_size != (long)workload.size() ||
+        snapshot.workload_checksum != workload_checksum(workload)) {
+        cerr << "Error: Checkpoint was taken on a different workload" << endl;
+        return false;
+    }
+    return true;
+}
+
+OnlineMetrics Simulation::resumeCFS(const CFSSnapshot& snapshot, const vector<Process>& extra) {
+    if (!matchesWorkload(snapshot)) {
+        return OnlineMetrics();
+    }
+    
+    // Extra arrivals get fresh pids past the loaded workload's largest, and
+    // cannot arrive before the checkpoint
+    int next_pid = 1;
+    for (const Process& p : workload) {
+        next_pid = max(next_pid, p.pid + 1);
+    }
+    vector<Process> injected = extra;
+    for (Process& p : injected) {
+        p.pid = next_pid++;
+        p.arrival = max(p.arrival, snapshot.time);
+        p.service = p.duration;
+        p.first_run = -1;
+        p.completion = -1;
+        p.vruntime = 0;
+        initializeWeight(p);
+    }
+    stable_sort(injected.begin(), injected.end(), [](const Process& a, const Process& b) {
+        return a.arrival < b.arrival;
+    });
+    
+    VectorFeed rest(workload, snapshot.arrivals_consumed);
+    VectorFeed added(injected);
+    MergedFeed feed(rest, added);
+    
+    OnlineMetrics metrics = snapshot.metrics;
+    CFSEngine<RBTreeRunQueue> engine(cfs_params, switch_cost);
+    engine.restore(snapshot);
+    engine.run(feed, metrics);
+    return metrics;
+}
+
+vector<OnlineMetrics> Simulation::forkCFS(const CFSSnapshot& snapshot,
+                                          const vector<vector<Process>>& scenarios) {
+    vector<OnlineMetrics> results(scenarios.size());
+    if (!matchesWorkload(snapshot)) {
+        return results;
+    }
+    parallel_for(scenarios.size(), [&](int i) {
+        results[i] = resumeCFS(snapshot, scenarios[i]);
+    });
+    return results;
+}
+
+bool Simulation::runFeed(ArrivalFeed& feed, CompletionSink& sink, string scheduler_type,
+                         SchedStats* stats) {
     if (scheduler_type == "stcf") {
-        return stcf(workload_copy);
+        stcf(feed, sink, switch_cost, stats);
     } else if (scheduler_type == "rr") {
-        return rr(workload_copy);
+        rr(feed, sink, rr_quantum, switch_cost, stats);
+    } else if (scheduler_type == "mlfq") {
+        mlfq(feed, sink, mlfq_config, switch_cost, stats);
     } else if (scheduler_type == "cfs") {
-        return cfs(workload_copy);
+        cfs(feed, sink, cfs_params, switch_cost, stats);
+    } else if (scheduler_type == "eevdf") {
+        eevdf(feed, sink, cfs_params, switch_cost, stats);
+    } else if (scheduler_type == "cfs_rbtree") {
+        cfs<RBTreeRunQueue>(feed, sink, cfs_params, switch_cost, stats);
+    } else if (scheduler_type == "cfs_pairing") {
+        cfs<PairingHeapRunQueue>(feed, sink, cfs_params, switch_cost, stats);
+    } else if (scheduler_type == "cfs_binheap") {
+        cfs<DaryHeapRunQueue<2>>(feed, sink, cfs_params, switch_cost, stats);
+    } else if (scheduler_type == "cfs_heap4") {
+        cfs<DaryHeapRunQueue<4>>(feed, sink, cfs_params, switch_cost, stats);
+    } else if (scheduler_type == "cfs_btree") {
+        cfs<BTreeRunQueue>(feed, sink, cfs_params, switch_cost, stats);
+    } else if (scheduler_type == "cfs_smp") {
+        cfs_smp(feed, sink, smp_config, &smp_stats, cfs_params, switch_cost, stats);
     } else {
         cout << "Invalid scheduler type: " << scheduler_type << endl;
-        return list<Process>();
+        return false;
     }
+    return true;
 }
 
-
-
 // Displays list of processes used in test case
 void show_processes(list<Process> processes) {
   list<Process> xs = processes;
@@ -159,10 +286,47 @@ void show_processes(list<Process> processes) {
 
 // Displays the metrics of scheduler performance
 void Simulation::compareSchedulers() {
-    // Run each scheduler
-    results["STCF"] = runScheduler("stcf");
-    results["RR"] = runScheduler("rr");
-    results["CFS"] = runScheduler("cfs");
+    // Run the schedulers concurrently over the same workload
+    vector<pair<string, string>> runs = {{"STCF", "stcf"}, {"RR", "rr"}, {"MLFQ", "mlfq"}, {"CFS", "cfs"}, {"EEVDF", "eevdf"}};
+    if (smp_config.num_cpus > 1) {
+        runs.push_back({"CFS-SMP", "cfs_smp"});
+    }
+    
+    // Metrics come from the columns; the list is kept for the completion order
+    vector<ListSink> outputs(runs.size());
+    vector<CompletionColumns> columns(runs.size());
+    vector<SchedStats> stats(runs.size());
+    parallel_for(runs.size(), [&](int i) {
+        VectorFeed feed(workload);
+        TeeSink sink(outputs[i], columns[i]);
+        columns[i].reserve(workload.size());
+        runFeed(feed, sink, runs[i].second, &stats[i]);
+    });
+    map<string, CompletionSpan> spans;
+    for (size_t i = 0; i < runs.size(); i++) {
+        results[runs[i].first] = std::move(outputs[i].processes);
+        spans[runs[i].first] = columns[i].span();
+        switch_stats[runs[i].first] = stats[i];
+    }
+    
+    // Dispatch overhead gets its own serial pass, so the runs do not compete
+    // for cores. Small workloads are repeated until the clock can resolve them.
+    map<string, double> overhead_ns;
+    for (auto const& [name, type] : runs) {
+        long rounds = 0;
+        double elapsed_ns = 0;
+        auto start = chrono::steady_clock::now();
+        do {
+            VectorFeed feed(workload);
+            CompletionColumns sink;
+            sink.reserve(workload.size());
+            runFeed(feed, sink, type);
+            rounds++;
+            elapsed_ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        } while (elapsed_ns < 1e6);
+        long dispatches = switch_stats[name].dispatches;
+        overhead_ns[name] = dispatches > 0 ? elapsed_ns / rounds / dispatches : 0.0;
+    }
     
     cout << "\n=== Scheduler Comparison ===\n";
     
@@ -172,13 +336,30 @@ void Simulation::compareSchedulers() {
         // Show completion order
         show_completion_order(processes);
         
-        float turnaround = avg_turnaround(processes);
-        float response = avg_response(processes);
-        float fairness = fairness_index(processes);
+        MetricsSummary summary = summarize(spans[name]);
+        LatencyHistogram response, turnaround, wait;
+        record_latencies(spans[name], response, turnaround, wait);
+        
+        cout << "Average Turnaround Time: " << summary.avg_turnaround << endl;
+        cout << "Average Response Time: " << summary.avg_response << endl;
+        cout << "Fairness Index: " << summary.fairness << endl;
+        show_percentiles(response, turnaround, wait);
+        show_switch_stats(switch_stats[name]);
+        // Wall time of whole runs per dispatch, so arrivals, completions and
+        // the sink dominate on small workloads. The pick itself is measured
+        // by bench/rbtree_bench (LevelBitmap against the CFS runqueue).
+        ios_base::fmtflags flags = cout.flags();
+        streamsize precision = cout.precision();
+        cout << "Dispatch Overhead:       " << fixed << setprecision(1) << overhead_ns[name]
+             << " ns wall time per dispatch, whole run ("
+             << switch_stats[name].dispatches << " dispatches)" << endl;
+        cout.flags(flags);
+        cout.precision(precision);
         
-        cout << "Average Turnaround Time: " << turnaround << endl;
-        cout << "Average Response Time: " << response << endl;
-        cout << "Fairness Index: " << fairness << endl;
+        if (name == "CFS-SMP") {
+            cout << "\nPer-CPU Statistics (" << smp_config.num_cpus << " CPUs):" << endl;
+            show_cpu_stats(smp_stats);
+        }
     }
     
     cout << "\n=== End of Comparison ===\n";
@@ -186,11 +367,9 @@ void Simulation::compareSchedulers() {
 
 // Displays the workload for a given test
 void Simulation::displayWorkload() {
-    pqueue_arrival workload_copy = workload;
     cout << "Current Workload:" << endl;
     
-    while (!workload_copy.empty()) {
-        Process p = workload_copy.top();
+    for (const Process& p : workload) {
         cout << "PID: " << p.pid 
              << ", Arrival: " << p.arrival 
              << ", Duration: " << p.duration;
@@ -204,7 +383,6 @@ void Simulation::displayWorkload() {
         }
         
         cout << endl;
-        workload_copy.pop();
     }
 }
 
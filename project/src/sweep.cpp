@@ -0,0 +1,91 @@
+#include "sweep.h"
+#include "schedulers.h"
+#include "metrics.h"
+#include "parallel.h"
+#include <algorithm>
+#include <iomanip>
+#include <random>
+
+using namespace std;
+
+// Every combination of the grid values
+vector<CFSParams> grid_configs(const SweepGrid& grid) {
+  vector<CFSParams> configs;
+  for (int latency : grid.target_latency) {
+    for (int granularity : grid.min_granularity) {
+      for (int weight : grid.nice_0_weight) {
+        for (float io_bonus : grid.io_bonus_factor) {
+          CFSParams params;
+          params.target_latency = latency;
+          params.min_granularity = granularity;
+          params.nice_0_weight = weight;
+          params.io_bonus_factor = io_bonus;
+          configs.push_back(params);
+        }
+      }
+    }
+  }
+  return configs;
+}
+
+// Uniform samples within the range spanned by each grid dimension. Drawn up
+// front from one seeded generator so results do not depend on thread count.
+vector<CFSParams> random_configs(const SweepGrid& grid, int samples, unsigned seed) {
+  mt19937 rng(seed);
+  auto pick_int = [&](const vector<int>& values, int fallback) {
+    if (values.empty()) return fallback;
+    auto [lo, hi] = minmax_element(values.begin(), values.end());
+    return uniform_int_distribution<int>(*lo, *hi)(rng);
+  };
+  auto pick_float = [&](const vector<float>& values, float fallback) {
+    if (values.empty()) return fallback;
+    auto [lo, hi] = minmax_element(values.begin(), values.end());
+    return uniform_real_distribution<float>(*lo, *hi)(rng);
+  };
+
+  vector<CFSParams> configs;
+  for (int i = 0; i < samples; i++) {
+    CFSParams params;
+    params.target_latency = pick_int(grid.target_latency, TARGET_LATENCY);
+    params.min_granularity = pick_int(grid.min_granularity, MIN_GRANULARITY);
+    params.nice_0_weight = pick_int(grid.nice_0_weight, NICE_0_WEIGHT);
+    params.io_bonus_factor = pick_float(grid.io_bonus_factor, IO_BONUS_FACTOR);
+    configs.push_back(params);
+  }
+  return configs;
+}
+
+vector<SweepResult> sweep_cfs(const vector<Process>& workload, const vector<CFSParams>& configs,
+                              int max_threads) {
+  vector<SweepResult> results(configs.size());
+
+  parallel_for(configs.size(), [&](int i) {
+    VectorFeed feed(workload);
+    OnlineMetrics metrics;
+    cfs(feed, metrics, configs[i]);
+
+    SweepResult& r = results[i];
+    r.params = configs[i];
+    r.turnaround = metrics.avgTurnaround();
+    r.response = metrics.avgResponse();
+    r.fairness = metrics.fairnessIndex();
+    r.throughput = metrics.throughput();
+  }, max_threads);
+
+  return results;
+}
+
+// One tab-separated row per configuration
+void write_sweep_table(const vector<SweepResult>& results, ostream& out) {
+  out << "Latency\tGranul.\tNice0W\tIOBonus\tTurnaround\tResponse\tFairness\tThroughput" << endl;
+  for (const SweepResult& r : results) {
+    out << r.params.target_latency << "\t"
+        << r.params.min_granularity << "\t"
+        << r.params.nice_0_weight << "\t"
+        << fixed << setprecision(2) << r.params.io_bonus_factor << "\t"
+        << r.turnaround << "\t\t"
+        << r.response << "\t\t"
+        << setprecision(4) << r.fairness << "\t\t"
+        << r.throughput << endl;
+  }
+}
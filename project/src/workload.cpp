@@ -0,0 +1,361 @@
+#include "workload.h"
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+const int nice_to_weight[40] = {
+  /* -20 */ 88761, 71755, 56483, 46273, 36291,
+  /* -15 */ 29154, 23254, 18705, 14949, 11916,
+  /* -10 */ 9548, 7620, 6100, 4904, 3906,
+  /*  -5 */ 3121, 2501, 1991, 1586, 1277,
+  /*   0 */ 1024, 820, 655, 526, 423,
+  /*   5 */ 335, 272, 215, 172, 137,
+  /*  10 */ 110, 87, 70, 56, 45,
+  /*  15 */ 36, 29, 23, 18, 15,
+};
+
+// Weights come from the table above rather than computing 1.25^-nice per process
+void initializeWeight(Process& p) {
+  // Convert nice value to index
+  int index = p.nice_value + 20;
+  
+  // Ensure index is within bounds
+  if (index < 0) {
+      index = 0;
+  } else if (index >= 40) {
+      index = 39;
+  }
+  
+  // Assign weight from lookup table
+  p.weight = nice_to_weight[index];
+}
+
+MappedFile::~MappedFile() {
+  if (addr != nullptr) {
+    munmap(addr, length);
+  }
+}
+
+bool MappedFile::open(string filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  length = st.st_size;
+  if (length > 0) {
+    addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      addr = nullptr;
+      length = 0;
+      close(fd);
+      return false;
+    }
+    // Records are consumed front to back exactly once
+    madvise(addr, length, MADV_SEQUENTIAL);
+  }
+  close(fd);
+  return true;
+}
+
+static void skip_space(const char*& cur, const char* end) {
+  while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r')) {
+    cur++;
+  }
+}
+
+template <typename T>
+static bool parse_field(const char*& cur, const char* end, T& value) {
+  skip_space(cur, end);
+  if (cur < end && *cur == '+') cur++;
+  from_chars_result res = from_chars(cur, end, value);
+  if (res.ec != errc()) {
+    return false;
+  }
+  cur = res.ptr;
+  return true;
+}
+
+bool parse_process(const char*& cur, const char* end, Process& p) {
+  int arrival, duration, nice_value, is_io_bound;
+  float io_ratio;
+
+  if (!parse_field(cur, end, arrival) || !parse_field(cur, end, duration) ||
+      !parse_field(cur, end, nice_value) || !parse_field(cur, end, is_io_bound) ||
+      !parse_field(cur, end, io_ratio)) {
+    return false;
+  }
+
+  p.arrival = arrival;
+  p.duration = duration;
+  p.service = duration;
+  p.first_run = -1;
+  p.completion = -1;
+  p.vruntime = 0;
+  p.nice_value = nice_value;
+  p.is_io_bound = is_io_bound;
+  p.io_ratio = io_ratio;
+  initializeWeight(p);
+  return true;
+}
+
+// Read workload from file
+pqueue_arrival read_workload(string filename) {
+  pqueue_arrival workload;
+  int next_pid = 1;
+
+  MappedFile file;
+  if(!file.open(filename)){
+    cerr << "Error: Unable to open file" << filename << endl;
+    return workload;
+  }
+
+  const char* cur = file.data();
+  const char* end = cur + file.size();
+  Process p;
+  while (parse_process(cur, end, p)) {
+    p.pid = next_pid++;
+    workload.push(p);
+  }
+  
+  return workload;
+}
+
+bool TextFeed::open(string filename) {
+  if (!file.open(filename)) {
+    cerr << "Error: Unable to open file" << filename << endl;
+    return false;
+  }
+  cur = file.data();
+  end = cur + file.size();
+  next_pid = 1;
+  advance();
+  return true;
+}
+
+void TextFeed::advance() {
+  has_next = parse_process(cur, end, next);
+  if (has_next) {
+    next.pid = next_pid++;
+  }
+}
+
+// Byte offset of each column, rounded up to 8 bytes
+static size_t column_offset(size_t offset, size_t column_bytes) {
+  return (offset + column_bytes + 7) & ~(size_t)7;
+}
+
+bool BinaryWorkload::open(string filename) {
+  if (!file.open(filename)) {
+    cerr << "Error: Unable to open file" << filename << endl;
+    return false;
+  }
+
+  WorkloadHeader header;
+  if (file.size() < sizeof(header)) {
+    cerr << "Error: Truncated workload file " << filename << endl;
+    return false;
+  }
+  memcpy(&header, file.data(), sizeof(header));
+  if (memcmp(header.magic, WORKLOAD_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != WORKLOAD_VERSION) {
+    cerr << "Error: Unsupported workload format in " << filename << endl;
+    return false;
+  }
+
+  // Bound the count by the file size first, so the offsets cannot overflow
+  const size_t row_bytes = 4 * sizeof(int32_t) + sizeof(int8_t) + sizeof(uint8_t);
+  if (header.count > (file.size() - sizeof(header)) / row_bytes) {
+    cerr << "Error: Truncated workload file " << filename << endl;
+    return false;
+  }
+
+  size_t n = header.count;
+  size_t pid_at = sizeof(header);
+  size_t arrival_at = column_offset(pid_at, n * sizeof(int32_t));
+  size_t duration_at = column_offset(arrival_at, n * sizeof(int32_t));
+  size_t io_ratio_at = column_offset(duration_at, n * sizeof(int32_t));
+  size_t nice_at = column_offset(io_ratio_at, n * sizeof(float));
+  size_t io_bound_at = column_offset(nice_at, n * sizeof(int8_t));
+  if (file.size() < io_bound_at + n * sizeof(uint8_t)) {
+    cerr << "Error: Truncated workload file " << filename << endl;
+    return false;
+  }
+
+  const char* base = file.data();
+  pid = (const int32_t*)(base + pid_at);
+  arrival = (const int32_t*)(base + arrival_at);
+  duration = (const int32_t*)(base + duration_at);
+  io_ratio = (const float*)(base + io_ratio_at);
+  nice = (const int8_t*)(base + nice_at);
+  is_io_bound = (const uint8_t*)(base + io_bound_at);
+  count = n;
+  return true;
+}
+
+void BinaryWorkload::get(size_t i, Process& p) const {
+  p.pid = pid[i];
+  p.arrival = arrival[i];
+  p.duration = duration[i];
+  p.service = duration[i];
+  p.first_run = -1;
+  p.completion = -1;
+  p.vruntime = 0;
+  p.nice_value = nice[i];
+  p.is_io_bound = is_io_bound[i];
+  p.io_ratio = io_ratio[i];
+  initializeWeight(p);
+}
+
+bool BinaryFeed::open(string filename) {
+  if (!workload.open(filename)) {
+    return false;
+  }
+  next_row = 0;
+  if (!empty()) {
+    workload.get(next_row, next);
+  }
+  return true;
+}
+
+void BinaryFeed::pop() {
+  next_row++;
+  if (!empty()) {
+    workload.get(next_row, next);
+  }
+}
+
+bool is_binary_workload(string filename) {
+  ifstream file(filename, ios::binary);
+  char magic[sizeof(WORKLOAD_MAGIC)];
+  if (!file.read(magic, sizeof(magic))) {
+    return false;
+  }
+  return memcmp(magic, WORKLOAD_MAGIC, sizeof(magic)) == 0;
+}
+
+vector<Process> load_workload(string filename) {
+  vector<Process> processes;
+
+  if (is_binary_workload(filename)) {
+    BinaryWorkload workload;
+    if (workload.open(filename)) {
+      processes.resize(workload.size());
+      for (size_t i = 0; i < workload.size(); i++) {
+        workload.get(i, processes[i]);
+      }
+    }
+    return processes;
+  }
+
+  pqueue_arrival arrivals = read_workload(filename);
+  processes.reserve(arrivals.size());
+  while (!arrivals.empty()) {
+    processes.push_back(arrivals.top());
+    arrivals.pop();
+  }
+  return processes;
+}
+
+// Writes one column followed by zero padding up to the next 8-byte boundary
+template <typename T>
+static void write_column(ofstream& out, const vector<T>& column) {
+  size_t bytes = column.size() * sizeof(T);
+  out.write((const char*)column.data(), bytes);
+  static const char zeros[8] = {0};
+  out.write(zeros, ((bytes + 7) & ~(size_t)7) - bytes);
+}
+
+uint64_t workload_checksum(const vector<Process>& processes) {
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+  };
+  for (const Process& p : processes) {
+    mix(&p.pid, sizeof(p.pid));
+    mix(&p.arrival, sizeof(p.arrival));
+    mix(&p.duration, sizeof(p.duration));
+    mix(&p.nice_value, sizeof(p.nice_value));
+    mix(&p.is_io_bound, sizeof(p.is_io_bound));
+    mix(&p.io_ratio, sizeof(p.io_ratio));
+  }
+  return hash;
+}
+
+bool write_text_workload(const vector<Process>& processes, string filename) {
+  ofstream out(filename);
+  if (!out.is_open()) {
+    cerr << "Error: Unable to open file" << filename << endl;
+    return false;
+  }
+
+  // Same record layout parse_process() reads; %.9g round-trips any float
+  char line[96];
+  for (const Process& p : processes) {
+    int len = snprintf(line, sizeof(line), "%d %d %d %d %.9g\n", p.arrival, p.duration,
+                       p.nice_value, p.is_io_bound ? 1 : 0, p.io_ratio);
+    out.write(line, len);
+  }
+  return out.good();
+}
+
+bool write_binary_workload(const vector<Process>& processes, string filename) {
+  ofstream out(filename, ios::binary);
+  if (!out.is_open()) {
+    cerr << "Error: Unable to open file" << filename << endl;
+    return false;
+  }
+
+  size_t n = processes.size();
+  vector<int32_t> pid(n), arrival(n), duration(n);
+  vector<float> io_ratio(n);
+  vector<int8_t> nice(n);
+  vector<uint8_t> is_io_bound(n);
+  for (size_t i = 0; i < n; i++) {
+    const Process& p = processes[i];
+    pid[i] = p.pid;
+    arrival[i] = p.arrival;
+    duration[i] = p.duration;
+    io_ratio[i] = p.io_ratio;
+    // Clamped as initializeWeight() does, so the narrowing cannot wrap a nice
+    // value around and both forms of a trace get the same weights
+    nice[i] = min(max(p.nice_value, -20), 19);
+    is_io_bound[i] = p.is_io_bound;
+  }
+
+  WorkloadHeader header;
+  memcpy(header.magic, WORKLOAD_MAGIC, sizeof(header.magic));
+  header.version = WORKLOAD_VERSION;
+  header.reserved = 0;
+  header.count = n;
+  out.write((const char*)&header, sizeof(header));
+
+  write_column(out, pid);
+  write_column(out, arrival);
+  write_column(out, duration);
+  write_column(out, io_ratio);
+  write_column(out, nice);
+  write_column(out, is_io_bound);
+  return out.good();
+}
+
+bool convert_workload(string text_file, string binary_file) {
+  return write_binary_workload(load_workload(text_file), binary_file);
+}
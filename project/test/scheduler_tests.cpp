@@ -1,11 +1,125 @@
 #include "../include/simulation.h"
 #include "../include/metrics.h"
 #include "../include/schedulers.h"
+#include "../include/rb_tree.h"
+#include "../include/workload.h"
+#include <climits>
 #include <iostream>
 #include <fstream>
 #include <string>
 
 using namespace std;
+
+static int collectNode(AugRBNode& node, void* out) {
+    ((vector<AugRBNode*>*)out)->push_back(&node);
+    return 0;
+}
+
+// Checks the order-statistic queries of an augmented tree against an inorder
+// walk. Returns the number of mismatches.
+static int checkOrderStatistics(AugmentedRBTree& tree) {
+    vector<AugRBNode*> nodes;
+    tree.apply(collectNode, &nodes);
+    
+    int errors = 0;
+    long long prefix = 0;
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        AugRBNode* node = nodes[i];
+        errors += tree.rank(node) != i;
+        errors += tree.select(i) != node;
+        errors += tree.selectByWeight(prefix) != node;
+        prefix += node->weight;
+        // Equal keys: only the last of a run has every node up to it counted
+        if (i + 1 == (int)nodes.size() || nodes[i + 1]->vruntime != node->vruntime) {
+            errors += tree.weightUpTo(node->vruntime) != prefix;
+        }
+    }
+    errors += tree.totalWeight() != prefix;
+    errors += tree.select(nodes.size()) != tree.search(-1);  // Out of range is nil
+    errors += tree.rank(tree.search(-1)) != -1;
+    if (!nodes.empty()) {
+        errors += tree.minKey() != nodes.front()->vruntime;
+        errors += tree.maxKey() != nodes.back()->vruntime;
+    }
+    return errors;
+}
+
+static void runOrderStatisticsTest() {
+    // Nice-weighted tasks, as EEVDF queues them, with repeated keys
+    AugmentedRBTree tree;
+    for (int id = 0; id < 200; id++) {
+        Process p = {};
+        p.nice_value = (id * 7) % 40 - 20;
+        initializeWeight(p);
+        tree.insert(id, (id * 37) % 101, id, p.weight);
+    }
+    int errors = checkOrderStatistics(tree);
+    
+    // Re-key and drop some, so the aggregates go through rotations
+    for (int id = 0; id < 200; id += 3) {
+        tree.requeue(tree.search(id), (id * 53) % 97, id + 1000);
+    }
+    for (int id = 1; id < 200; id += 4) {
+        tree.remove(id);
+    }
+    errors += checkOrderStatistics(tree);
+    
+    // Reused nodes must not keep the deadline or weight of the removed ones
+    for (int id = 1; id < 200; id += 4) {
+        tree.insert(id, id % 13);
+        AugRBNode* node = tree.search(id);
+        errors += node->deadline != 0 || node->weight != 1;
+    }
+    errors += checkOrderStatistics(tree);
+    
+    cout << "Order statistics on " << tree.size() << " nodes: "
+         << (errors == 0 ? "match" : "MISMATCH") << " (" << errors << " errors)\n";
+}
+
+static bool sameMetrics(const OnlineMetrics& a, const OnlineMetrics& b) {
+    return a.count() == b.count() && a.avgTurnaround() == b.avgTurnaround() &&
+           a.avgResponse() == b.avgResponse() && a.fairnessIndex() == b.fairnessIndex() &&
+           a.totalTime() == b.totalTime() &&
+           a.turnaroundHistogram().percentile(99) == b.turnaroundHistogram().percentile(99) &&
+           a.responseHistogram().percentile(99) == b.responseHistogram().percentile(99);
+}
+
+// Checkpoints CFS at several times, round-trips each snapshot through a file
+// and resumes it; every resumed run must match the uninterrupted one
+static void runCheckpointTest(Simulation& sim) {
+    OnlineMetrics full = sim.checkpointCFS(INT_MAX).metrics;
+    cout << "Uninterrupted run: " << full.count() << " processes, average turnaround "
+         << full.avgTurnaround() << ", last completion " << full.totalTime() << "\n";
+    
+    const int untils[] = {0, 7, 40, 150, full.totalTime() - 1};
+    string snapshot_file = "test8_checkpoint.bin";
+    for (int until : untils) {
+        CFSSnapshot saved = sim.checkpointCFS(until);
+        CFSSnapshot loaded;
+        bool ok = save_snapshot(saved, snapshot_file) && load_snapshot(snapshot_file, loaded);
+        ok = ok && sameMetrics(sim.resumeCFS(loaded), full);
+        cout << "Resume from time " << saved.time << " (" << saved.metrics.count()
+             << " done): " << (ok ? "match" : "MISMATCH") << "\n";
+    }
+    
+    // Fork one warm-up: unchanged, and with a late heavy arrival
+    CFSSnapshot warm = sim.checkpointCFS(40);
+    Process heavy = {};
+    heavy.arrival = warm.time;
+    heavy.duration = 100;
+    heavy.nice_value = -10;
+    vector<OnlineMetrics> forks = sim.forkCFS(warm, {{}, {heavy}});
+    cout << "Fork unchanged: " << (sameMetrics(forks[0], full) ? "match" : "MISMATCH") << "\n";
+    cout << "Fork with a nice -10 arrival at " << warm.time << ": " << forks[1].count()
+         << " processes, average turnaround " << forks[1].avgTurnaround() << "\n";
+    
+    // A snapshot only fits the workload it was taken on
+    Simulation other;
+    other.generateTestWorkload(1);
+    cout << "Resume on another workload: "
+         << (other.resumeCFS(warm).count() == 0 ? "refused" : "ACCEPTED") << "\n";
+}
+
 // Function to run a specific test
 void runTest(int test_number) {
     Simulation sim;
@@ -59,7 +173,11 @@ void runTest(int test_number) {
             
             cout << "\n=== Test 3: I/O-Bound vs. CPU-Bound Test ===\n";
             cout << "This test evaluates how schedulers handle mixed I/O and CPU-bound processes.\n";
-            cout << "We expect CFS to give preference to I/O-bound processes for better interactive performance.\n\n";
+            cout << "We expect CFS to give preference to I/O-bound processes for better interactive performance.\n";
+            cout << "I/O-bound processes block for I/O after every 4 units of CPU in CFS.\n\n";
+            CFSParams params;
+            params.io_burst = 4;
+            sim.setCFSParams(params);
             break;
         }
         case 4: { // Priority Inversion Test
@@ -99,6 +217,58 @@ void runTest(int test_number) {
             cout << "We expect to see how each scheduler scales with increasing system load.\n\n";
             break;
         }
+        case 6: { // Multi-core Test
+            filename = "test6_multicore.txt";
+            ofstream outfile(filename);
+            // Bursts of mixed-priority processes, more than one CPU can keep up with
+            for (int i = 0; i < 40; i++) {
+                int arrival = (i / 8) * 10;  // Groups of 8 every 10 time units
+                int duration = 10 + (i % 4) * 10;  // Durations from 10 to 40
+                int nice = (i % 5) * 5 - 10;  // Nice values from -10 to 10
+                outfile << arrival << " " << duration << " " << nice << " 0 0.0\n";
+            }
+            outfile.close();
+            sim.setCPUs(4);
+            
+            cout << "\n=== Test 6: Multi-core Test ===\n";
+            cout << "This test evaluates CFS with one runqueue per CPU and load balancing across 4 CPUs.\n";
+            cout << "We expect CFS-SMP to spread load evenly with few migrations and much lower turnaround.\n\n";
+            break;
+        }
+        case 7: { // Augmented Tree Test
+            cout << "\n=== Test 7: Augmented Tree Test ===\n";
+            cout << "This test checks rank, select and weight queries of the EEVDF runqueue tree\n";
+            cout << "against an inorder walk, before and after requeues and removals.\n\n";
+            runOrderStatisticsTest();
+            return;
+        }
+        case 8: { // Checkpoint Test
+            filename = "test8_checkpoint.txt";
+            ofstream outfile(filename);
+            // Staggered mixed-priority processes, a third of them doing I/O
+            for (int i = 0; i < 40; i++) {
+                int arrival = i * 3;
+                int duration = 5 + (i * 7) % 20;
+                int nice = (i % 9) * 2 - 8;
+                bool io_bound = (i % 3 == 0);
+                outfile << arrival << " " << duration << " " << nice << " "
+                        << (io_bound ? 1 : 0) << " " << (io_bound ? 0.6 : 0.0) << "\n";
+            }
+            outfile.close();
+            CFSParams params;
+            params.io_burst = 4;
+            sim.setCFSParams(params);
+            
+            cout << "\n=== Test 8: Checkpoint Test ===\n";
+            cout << "This test pauses CFS at several times, saves and reloads the snapshot, and resumes it.\n";
+            cout << "We expect every resumed run, and an unchanged fork, to match the uninterrupted run.\n\n";
+            if (sim.loadProcesses(filename)) {
+                runCheckpointTest(sim);
+            } else {
+                cout << "Failed to load workload from " << filename << endl;
+            }
+            return;
+        }
         default:
             cout << "Invalid test number\n";
             return;
@@ -126,7 +296,7 @@ int main(int argc, char* argv[]) {
         runTest(test_num);
     } else {
         // Run all tests
-        for (int i = 1; i <= 5; i++) {
+        for (int i = 1; i <= 8; i++) {
             runTest(i);
         }
     }
@@ -0,0 +1,30 @@
+#include "../include/workload.h"
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Converts a text workload (arrival duration nice is_io_bound io_ratio per
+// line) into the binary columnar format read by Simulation::loadProcesses()
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        cout << "Usage: " << argv[0] << " <workload.txt> <workload.bin>\n";
+        return 1;
+    }
+    
+    string text_file = argv[1];
+    string binary_file = argv[2];
+    
+    if (is_binary_workload(text_file)) {
+        cerr << text_file << " is already a binary workload\n";
+        return 1;
+    }
+    
+    if (!convert_workload(text_file, binary_file)) {
+        cerr << "Conversion failed\n";
+        return 1;
+    }
+    
+    cout << "Wrote " << binary_file << endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "../include/generator.h"
+#include "../include/workload.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Writes a synthetic workload. Output ending in .bin uses the binary columnar
+// format, anything else the text format.
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " <output> <count> [seed] [rate] [mean_duration]"
+             << " [pareto|lognormal|exponential] [poisson|bursty] [io_fraction]\n";
+        return 1;
+    }
+
+    string output_file = argv[1];
+    GeneratorConfig config;
+    config.count = atol(argv[2]);
+    if (argc > 3) config.seed = strtoull(argv[3], nullptr, 10);
+    if (argc > 4) config.arrival_rate = atof(argv[4]);
+    if (argc > 5) config.mean_duration = atof(argv[5]);
+    if (argc > 6) {
+        string dist = argv[6];
+        if (dist == "pareto") {
+            config.durations = DurationDistribution::PARETO;
+        } else if (dist == "lognormal") {
+            config.durations = DurationDistribution::LOGNORMAL;
+            config.duration_shape = 1.0;
+        } else if (dist == "exponential") {
+            config.durations = DurationDistribution::EXPONENTIAL;
+        } else {
+            cerr << "Unknown duration distribution: " << dist << endl;
+            return 1;
+        }
+    }
+    if (argc > 7) {
+        string pattern = argv[7];
+        if (pattern == "poisson") {
+            config.arrivals = ArrivalPattern::POISSON;
+        } else if (pattern == "bursty") {
+            config.arrivals = ArrivalPattern::BURSTY;
+        } else {
+            cerr << "Unknown arrival pattern: " << pattern << endl;
+            return 1;
+        }
+    }
+    if (argc > 8) config.io_fraction = atof(argv[8]);
+
+    // A realistic spread of priorities, centred on nice 0
+    config.nice_mix = {{-10, 1}, {-5, 2}, {0, 4}, {5, 2}, {10, 1}};
+
+    vector<Process> processes = generate_workload(config);
+
+    bool binary = output_file.size() >= 4 && output_file.compare(output_file.size() - 4, 4, ".bin") == 0;
+    bool ok = binary ? write_binary_workload(processes, output_file)
+                     : write_text_workload(processes, output_file);
+    if (!ok) {
+        cerr << "Failed to write " << output_file << endl;
+        return 1;
+    }
+
+    cout << "Wrote " << processes.size() << " processes to " << output_file << endl;
+    return 0;
+}